@@ -0,0 +1,70 @@
+// Building and throwing away a parse tree's worth of small nodes: one new and
+// delete per node, vs std::pmr::monotonic_buffer_resource, vs an arena
+// (normal and huge page chunks) that's reset after each tree.
+#include <bitpack/bitpack.hpp>
+
+#include <benchmark/benchmark.h>
+
+#include <cstdint>
+#include <memory_resource>
+#include <vector>
+
+namespace {
+struct ast_node {
+  std::uint32_t kind;
+  std::uint32_t token;
+  ast_node*     lhs;
+  ast_node*     rhs;
+};
+
+// a left leaning chain of n binary nodes, like a long expression
+template<class Make> ast_node* build(std::size_t const n, Make make) {
+  ast_node* root = nullptr;
+  for(std::size_t i = 0; i < n; ++i)
+    root = make(ast_node{static_cast<std::uint32_t>(i % 7),
+                         static_cast<std::uint32_t>(i),
+                         root,
+                         nullptr});
+  return root;
+}
+
+void BM_alloc_new_delete(benchmark::State& state) {
+  for(auto _ : state) {
+    auto* root = build(state.range(0),
+                       [](ast_node const n) { return new ast_node{n}; });
+    benchmark::DoNotOptimize(root);
+    while(root != nullptr) delete std::exchange(root, root->lhs);
+  }
+  state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+BENCHMARK(BM_alloc_new_delete)->Range(1 << 10, 1 << 18);
+
+void BM_alloc_pmr_monotonic(benchmark::State& state) {
+  std::pmr::monotonic_buffer_resource resource;
+  for(auto _ : state) {
+    benchmark::DoNotOptimize(build(state.range(0), [&](ast_node const n) {
+      return ::new(resource.allocate(sizeof(ast_node), alignof(ast_node)))
+          ast_node{n};
+    }));
+    resource.release();
+  }
+  state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+BENCHMARK(BM_alloc_pmr_monotonic)->Range(1 << 10, 1 << 18);
+
+template<bitpack::arena_pages pages>
+void BM_alloc_arena(benchmark::State& state) {
+  bitpack::arena<> arena{bitpack::arena<>::default_chunk_size, pages};
+  for(auto _ : state) {
+    benchmark::DoNotOptimize(build(state.range(0), [&](ast_node const n) {
+      return arena.make<ast_node>(n);
+    }));
+    arena.reset();
+  }
+  state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+BENCHMARK_TEMPLATE(BM_alloc_arena, bitpack::arena_pages::normal)
+    ->Range(1 << 10, 1 << 18);
+BENCHMARK_TEMPLATE(BM_alloc_arena, bitpack::arena_pages::huge)
+    ->Range(1 << 10, 1 << 18);
+} // namespace
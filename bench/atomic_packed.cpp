@@ -0,0 +1,73 @@
+// Two counters kept together (references and pending operations), bumped one
+// at a time: two fields behind a std::mutex vs an atomic_packed, where each
+// update is one atomic add, and vs a CAS loop (atomic_packed::update).
+#include <bitpack/bitpack.hpp>
+
+#include <benchmark/benchmark.h>
+
+#include <atomic>
+#include <cstdint>
+#include <mutex>
+
+namespace {
+using counters =
+    bitpack::UInt_pair<std::uint32_t, std::uint32_t, std::uint64_t>;
+
+class mutex_counters {
+ public:
+  void start() {
+    std::scoped_lock const lock{mutex_};
+    ++pending_;
+  }
+  void finish() {
+    std::scoped_lock const lock{mutex_};
+    --pending_;
+  }
+
+ private:
+  std::mutex    mutex_;
+  std::uint32_t refs_ = 1, pending_ = 0;
+};
+
+class packed_counters {
+ public:
+  void start() { word_.fetch_add_y(1, std::memory_order_relaxed); }
+  void finish() { word_.fetch_sub_y(1, std::memory_order_relaxed); }
+
+ private:
+  bitpack::atomic_packed<counters> word_{counters{1, 0}};
+};
+
+class cas_counters {
+ public:
+  void start() {
+    word_.update([](counters const c) { return counters{c.x(), c.y() + 1}; },
+                 std::memory_order_relaxed);
+  }
+  void finish() {
+    word_.update([](counters const c) { return counters{c.x(), c.y() - 1}; },
+                 std::memory_order_relaxed);
+  }
+
+ private:
+  bitpack::atomic_packed<counters> word_{counters{1, 0}};
+};
+
+template<class Counters> void BM_counters(benchmark::State& state) {
+  static Counters counters;
+  for(auto _ : state) {
+    counters.start();
+    counters.finish();
+  }
+  state.SetItemsProcessed(state.iterations() * 2);
+}
+BENCHMARK_TEMPLATE(BM_counters, mutex_counters)
+    ->ThreadRange(1, 4)
+    ->UseRealTime();
+BENCHMARK_TEMPLATE(BM_counters, packed_counters)
+    ->ThreadRange(1, 4)
+    ->UseRealTime();
+BENCHMARK_TEMPLATE(BM_counters, cas_counters)
+    ->ThreadRange(1, 4)
+    ->UseRealTime();
+} // namespace
@@ -0,0 +1,124 @@
+// Splitting packed pairs into columns (and back): bitpack::unpack/pack vs
+// calling x()/y() (or the constructor) per element. And a GC style marking
+// pass over tagged pointers: rebuilding each one vs set_tag vs set_tags.
+#include <bitpack/bitpack.hpp>
+
+#include <benchmark/benchmark.h>
+
+#include <cstdint>
+#include <random>
+#include <vector>
+
+namespace {
+using pair = bitpack::UInt_pair<std::uint32_t, std::uint32_t, std::uint64_t>;
+
+std::vector<pair> random_pairs(std::size_t const n) {
+  std::mt19937                                 gen{42};
+  std::uniform_int_distribution<std::uint32_t> dist;
+  std::vector<pair>                            out;
+  out.reserve(n);
+  for(std::size_t i = 0; i < n; ++i) out.emplace_back(dist(gen), dist(gen));
+  return out;
+}
+
+void BM_unpack_per_element(benchmark::State& state) {
+  auto const                 pairs = random_pairs(state.range(0));
+  std::vector<std::uint32_t> xs(pairs.size()), ys(pairs.size());
+  for(auto _ : state) {
+    for(std::size_t i = 0; i < pairs.size(); ++i) {
+      xs[i] = pairs[i].x();
+      ys[i] = pairs[i].y();
+    }
+    benchmark::ClobberMemory();
+  }
+  state.SetBytesProcessed(state.iterations() * state.range(0) * sizeof(pair));
+}
+BENCHMARK(BM_unpack_per_element)->Range(1 << 10, 1 << 20);
+
+void BM_unpack_bulk(benchmark::State& state) {
+  auto const                 pairs = random_pairs(state.range(0));
+  std::vector<std::uint32_t> xs(pairs.size()), ys(pairs.size());
+  for(auto _ : state) {
+    bitpack::unpack(std::span{pairs}, xs, ys);
+    benchmark::ClobberMemory();
+  }
+  state.SetBytesProcessed(state.iterations() * state.range(0) * sizeof(pair));
+}
+BENCHMARK(BM_unpack_bulk)->Range(1 << 10, 1 << 20);
+
+void BM_pack_per_element(benchmark::State& state) {
+  auto const                 src = random_pairs(state.range(0));
+  std::vector<std::uint32_t> xs(src.size()), ys(src.size());
+  bitpack::unpack(std::span{src}, xs, ys);
+  std::vector<pair> pairs(src.size());
+  for(auto _ : state) {
+    for(std::size_t i = 0; i < pairs.size(); ++i) pairs[i] = pair{xs[i], ys[i]};
+    benchmark::ClobberMemory();
+  }
+  state.SetBytesProcessed(state.iterations() * state.range(0) * sizeof(pair));
+}
+BENCHMARK(BM_pack_per_element)->Range(1 << 10, 1 << 20);
+
+void BM_pack_bulk(benchmark::State& state) {
+  auto const                 src = random_pairs(state.range(0));
+  std::vector<std::uint32_t> xs(src.size()), ys(src.size());
+  bitpack::unpack(std::span{src}, xs, ys);
+  std::vector<pair> pairs(src.size());
+  for(auto _ : state) {
+    bitpack::pack(std::span<std::uint32_t const>{xs},
+                  std::span<std::uint32_t const>{ys},
+                  std::span{pairs});
+    benchmark::ClobberMemory();
+  }
+  state.SetBytesProcessed(state.iterations() * state.range(0) * sizeof(pair));
+}
+BENCHMARK(BM_pack_bulk)->Range(1 << 10, 1 << 20);
+
+using marked_ptr = bitpack::tagged_ptr<std::uint64_t*, bool, 1>;
+
+std::vector<marked_ptr> unmarked_ptrs(std::vector<std::uint64_t>& objects) {
+  std::vector<marked_ptr> ptrs;
+  ptrs.reserve(objects.size());
+  for(auto& o : objects) ptrs.emplace_back(&o, false);
+  return ptrs;
+}
+
+void BM_mark_rebuild(benchmark::State& state) {
+  std::vector<std::uint64_t> objects(state.range(0));
+  auto                       ptrs = unmarked_ptrs(objects);
+  bool                       mark = false;
+  for(auto _ : state) {
+    mark = !mark;
+    for(auto& p : ptrs) p = marked_ptr{p.ptr(), mark};
+    benchmark::ClobberMemory();
+  }
+  state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+BENCHMARK(BM_mark_rebuild)->Range(1 << 10, 1 << 22);
+
+void BM_mark_set_tag(benchmark::State& state) {
+  std::vector<std::uint64_t> objects(state.range(0));
+  auto                       ptrs = unmarked_ptrs(objects);
+  bool                       mark = false;
+  for(auto _ : state) {
+    mark = !mark;
+    for(auto& p : ptrs) p.set_tag(mark);
+    benchmark::ClobberMemory();
+  }
+  state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+BENCHMARK(BM_mark_set_tag)->Range(1 << 10, 1 << 22);
+
+void BM_mark_set_tags(benchmark::State& state) {
+  std::vector<std::uint64_t> objects(state.range(0));
+  auto                       ptrs = unmarked_ptrs(objects);
+  bool                       mark = false;
+  for(auto _ : state) {
+    mark = !mark;
+    bitpack::set_tags(std::span{ptrs}, mark);
+    benchmark::ClobberMemory();
+  }
+  state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+BENCHMARK(BM_mark_set_tags)->Range(1 << 10, 1 << 22);
+} // namespace
@@ -0,0 +1,81 @@
+// Searching a binary search tree whose child links are raw pointers (24 byte
+// nodes) vs compressed_ptrs into one arena (12 byte nodes). The smaller nodes
+// mean twice as many fit in each level of cache.
+#include <bitpack/bitpack.hpp>
+
+#include <benchmark/benchmark.h>
+
+#include <algorithm>
+#include <cstdint>
+#include <memory>
+#include <new>
+#include <random>
+#include <vector>
+
+namespace {
+struct tree_arena {
+  static inline std::unique_ptr<std::byte[]> memory;
+  static std::byte* base() noexcept { return memory.get(); }
+};
+
+struct raw_node {
+  std::uint32_t key;
+  raw_node*     left  = nullptr;
+  raw_node*     right = nullptr;
+};
+struct compressed_node {
+  using link = bitpack::compressed_ptr<compressed_node, tree_arena>;
+  std::uint32_t key;
+  link          left  = nullptr;
+  link          right = nullptr;
+};
+
+std::vector<std::uint32_t> random_keys(std::size_t const n) {
+  std::mt19937               gen{42};
+  std::vector<std::uint32_t> keys(n);
+  for(auto& k : keys) k = gen();
+  return keys;
+}
+
+// an unbalanced BST of the keys in insertion order (random, so ~1.4 log n
+// deep), with its nodes laid out in the arena in that order
+template<class Node> Node* build_tree(std::vector<std::uint32_t> const& keys) {
+  auto const bytes   = keys.size() * sizeof(Node);
+  tree_arena::memory = std::make_unique<std::byte[]>(bytes);
+  auto* const nodes  = reinterpret_cast<Node*>(tree_arena::base());
+  for(std::size_t i = 0; i < keys.size(); ++i) {
+    auto* const n = ::new(&nodes[i]) Node{keys[i]};
+    if(i == 0) continue;
+    for(Node* at = nodes;;) {
+      auto& child = n->key < at->key ? at->left : at->right;
+      if(child == nullptr) {
+        child = n;
+        break;
+      }
+      at = child;
+    }
+  }
+  return nodes;
+}
+
+template<class Node> void BM_tree_search(benchmark::State& state) {
+  auto const  keys    = random_keys(state.range(0));
+  Node* const root    = build_tree<Node>(keys);
+  auto        lookups = keys;
+  std::shuffle(lookups.begin(), lookups.end(), std::mt19937{7});
+  for(auto _ : state) {
+    std::uint64_t depth = 0;
+    for(auto const key : lookups) {
+      Node* at = root;
+      while(at->key != key) {
+        at = key < at->key ? at->left : at->right;
+        ++depth;
+      }
+    }
+    benchmark::DoNotOptimize(depth);
+  }
+  state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+BENCHMARK_TEMPLATE(BM_tree_search, raw_node)->Range(1 << 10, 1 << 20);
+BENCHMARK_TEMPLATE(BM_tree_search, compressed_node)->Range(1 << 10, 1 << 20);
+} // namespace
@@ -0,0 +1,115 @@
+// Walking an expression tree: virtual functions vs derived_variant_ptr's
+// visit over the same (closed) set of node classes. The variant version
+// reads the type from the pointer's tag instead of loading the vtable from
+// the node, and the visitor is inlined into a switch.
+#include <bitpack/bitpack.hpp>
+
+#include <benchmark/benchmark.h>
+
+#include <cstdint>
+#include <memory>
+#include <random>
+#include <vector>
+
+namespace {
+// the classic version: an abstract base class
+struct virtual_node {
+  virtual ~virtual_node()           = default;
+  virtual std::int64_t eval() const = 0;
+};
+struct virtual_number final : virtual_node {
+  explicit virtual_number(std::int64_t const v) : value{v} {}
+  std::int64_t eval() const override { return value; }
+  std::int64_t value;
+};
+struct virtual_add final : virtual_node {
+  virtual_add(virtual_node* const l, virtual_node* const r) : lhs{l}, rhs{r} {}
+  std::int64_t  eval() const override { return lhs->eval() + rhs->eval(); }
+  virtual_node* lhs;
+  virtual_node* rhs;
+};
+struct virtual_mul final : virtual_node {
+  virtual_mul(virtual_node* const l, virtual_node* const r) : lhs{l}, rhs{r} {}
+  std::int64_t  eval() const override { return lhs->eval() * rhs->eval(); }
+  virtual_node* lhs;
+  virtual_node* rhs;
+};
+
+// the same tree with the kind in the child pointers
+struct alignas(8) node {};
+struct number;
+struct add;
+struct mul;
+using node_ptr = bitpack::derived_variant_ptr<node, number, add, mul>;
+struct number : node {
+  std::int64_t value;
+};
+struct add : node {
+  node_ptr lhs, rhs;
+};
+struct mul : node {
+  node_ptr lhs, rhs;
+};
+
+struct evaluate {
+  std::int64_t operator()(number const* n) const { return n->value; }
+  std::int64_t operator()(add const* a) const {
+    return bitpack::visit(*this, a->lhs) + bitpack::visit(*this, a->rhs);
+  }
+  std::int64_t operator()(mul const* m) const {
+    return bitpack::visit(*this, m->lhs) * bitpack::visit(*this, m->rhs);
+  }
+};
+
+// A random tree with `leaves` leaves, built by both factories at once, so the
+// two trees have the same shape and node order in memory
+template<class Leaf, class Add, class Mul>
+auto random_tree(std::size_t const leaves,
+                 std::mt19937&     gen,
+                 Leaf              leaf,
+                 Add               plus,
+                 Mul               times) -> decltype(leaf(0)) {
+  if(leaves == 1) return leaf(static_cast<std::int64_t>(gen() % 3));
+  auto const left = 1 + gen() % (leaves - 1);
+  auto const l    = random_tree(left, gen, leaf, plus, times);
+  auto const r    = random_tree(leaves - left, gen, leaf, plus, times);
+  return gen() % 2 ? plus(l, r) : times(l, r);
+}
+
+void BM_tree_eval_virtual(benchmark::State& state) {
+  std::vector<std::unique_ptr<virtual_node>> nodes;
+  auto const keep = [&](virtual_node* const n) {
+    nodes.emplace_back(n);
+    return n;
+  };
+  std::mt19937 gen{42};
+  auto* const  root = random_tree(
+      state.range(0),
+      gen,
+      [&](std::int64_t v) { return keep(new virtual_number{v}); },
+      [&](auto l, auto r) { return keep(new virtual_add{l, r}); },
+      [&](auto l, auto r) { return keep(new virtual_mul{l, r}); });
+  for(auto _ : state) benchmark::DoNotOptimize(root->eval());
+  state.SetItemsProcessed(state.iterations() * nodes.size());
+}
+BENCHMARK(BM_tree_eval_virtual)->Range(1 << 8, 1 << 16);
+
+void BM_tree_eval_derived_variant_ptr(benchmark::State& state) {
+  std::vector<std::unique_ptr<node>> nodes;
+  auto const keep = [&](auto* const n) {
+    nodes.emplace_back(n);
+    return node_ptr{n};
+  };
+  std::mt19937 gen{42};
+  auto const   root = random_tree(
+      state.range(0),
+      gen,
+      [&](std::int64_t v) { return keep(new number{{}, v}); },
+      [&](auto l, auto r) { return keep(new add{{}, l, r}); },
+      [&](auto l, auto r) { return keep(new mul{{}, l, r}); });
+  for(auto _ : state)
+    benchmark::DoNotOptimize(bitpack::visit(evaluate{}, root));
+  state.SetItemsProcessed(state.iterations() * nodes.size());
+}
+BENCHMARK(BM_tree_eval_derived_variant_ptr)->Range(1 << 8, 1 << 16);
+} // namespace
@@ -0,0 +1,46 @@
+// Push/pop throughput of lockfree_queue vs a std::mutex-guarded std::deque,
+// with every thread both producing and consuming on the same queue.
+#include <bitpack/bitpack.hpp>
+
+#include <benchmark/benchmark.h>
+
+#include <deque>
+#include <mutex>
+#include <optional>
+
+namespace {
+// the baseline: what you'd write without a lock-free queue
+template<class T> class mutex_queue {
+ public:
+  void push(T const value) {
+    std::scoped_lock const lock{mutex_};
+    items_.push_back(value);
+  }
+  std::optional<T> pop() {
+    std::scoped_lock const lock{mutex_};
+    if(items_.empty()) return std::nullopt;
+    T const out = items_.front();
+    items_.pop_front();
+    return out;
+  }
+
+ private:
+  std::mutex    mutex_;
+  std::deque<T> items_;
+};
+
+template<class Queue> void BM_queue_push_pop(benchmark::State& state) {
+  static Queue queue;
+  for(auto _ : state) {
+    queue.push(state.thread_index());
+    benchmark::DoNotOptimize(queue.pop());
+  }
+  state.SetItemsProcessed(state.iterations() * 2);
+}
+BENCHMARK_TEMPLATE(BM_queue_push_pop, bitpack::lockfree_queue<int>)
+    ->ThreadRange(1, 16)
+    ->UseRealTime();
+BENCHMARK_TEMPLATE(BM_queue_push_pop, mutex_queue<int>)
+    ->ThreadRange(1, 16)
+    ->UseRealTime();
+} // namespace
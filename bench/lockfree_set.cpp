@@ -0,0 +1,66 @@
+// Membership queries with N reader threads: lockfree_set vs a std::set
+// behind a std::shared_mutex. Readers shouldn't slow each other down.
+#include <bitpack/bitpack.hpp>
+
+#include <benchmark/benchmark.h>
+
+#include <mutex>
+#include <set>
+#include <shared_mutex>
+
+namespace {
+constexpr int keys = 256;
+
+// the baseline: what you'd write without a lock-free set
+template<class Key> class shared_mutex_set {
+ public:
+  bool insert(Key const& key) {
+    std::unique_lock const lock{mutex_};
+    return items_.insert(key).second;
+  }
+  bool contains(Key const& key) {
+    std::shared_lock const lock{mutex_};
+    return items_.contains(key);
+  }
+
+ private:
+  std::shared_mutex mutex_;
+  std::set<Key>     items_;
+};
+
+template<class Set> Set& even_keys() {
+  static Set set;
+  static bool const filled = [] {
+    for(int i = 0; i < keys; i += 2) set.insert(i);
+    return true;
+  }();
+  (void)filled;
+  return set;
+}
+
+template<class Set> void BM_set_contains(benchmark::State& state) {
+  auto& set = even_keys<Set>();
+  int   key = state.thread_index();
+  for(auto _ : state) {
+    benchmark::DoNotOptimize(set.contains(key));
+    key = (key + 7) % keys;
+  }
+  state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK_TEMPLATE(BM_set_contains, bitpack::lockfree_set<int>)
+    ->ThreadRange(1, 8)
+    ->UseRealTime();
+BENCHMARK_TEMPLATE(
+    BM_set_contains,
+    bitpack::lockfree_set<int, std::less<>, bitpack::epoch_reclaimer>)
+    ->ThreadRange(1, 8)
+    ->UseRealTime();
+BENCHMARK_TEMPLATE(
+    BM_set_contains,
+    bitpack::lockfree_set<int, std::less<>, bitpack::hazard_reclaimer>)
+    ->ThreadRange(1, 8)
+    ->UseRealTime();
+BENCHMARK_TEMPLATE(BM_set_contains, shared_mutex_set<int>)
+    ->ThreadRange(1, 8)
+    ->UseRealTime();
+} // namespace
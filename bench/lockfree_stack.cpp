@@ -0,0 +1,46 @@
+// Push/pop throughput of lockfree_stack vs a std::mutex-guarded std::vector,
+// with every thread hammering the same stack.
+#include <bitpack/bitpack.hpp>
+
+#include <benchmark/benchmark.h>
+
+#include <mutex>
+#include <optional>
+#include <vector>
+
+namespace {
+// the baseline: what you'd write without a lock-free stack
+template<class T> class mutex_stack {
+ public:
+  void push(T const value) {
+    std::scoped_lock const lock{mutex_};
+    items_.push_back(value);
+  }
+  std::optional<T> pop() {
+    std::scoped_lock const lock{mutex_};
+    if(items_.empty()) return std::nullopt;
+    T const out = items_.back();
+    items_.pop_back();
+    return out;
+  }
+
+ private:
+  std::mutex     mutex_;
+  std::vector<T> items_;
+};
+
+template<class Stack> void BM_stack_push_pop(benchmark::State& state) {
+  static Stack stack;
+  for(auto _ : state) {
+    stack.push(state.thread_index());
+    benchmark::DoNotOptimize(stack.pop());
+  }
+  state.SetItemsProcessed(state.iterations() * 2);
+}
+BENCHMARK_TEMPLATE(BM_stack_push_pop, bitpack::lockfree_stack<int>)
+    ->ThreadRange(1, 8)
+    ->UseRealTime();
+BENCHMARK_TEMPLATE(BM_stack_push_pop, mutex_stack<int>)
+    ->ThreadRange(1, 8)
+    ->UseRealTime();
+} // namespace
@@ -0,0 +1,68 @@
+// Scanning records: a plain struct (padded to 12 bytes) vs the same fields in
+// a packed_struct (8 bytes). The scan counts the flagged records in an id
+// range, so it's bound by how many bytes it reads.
+#include <bitpack/bitpack.hpp>
+
+#include <benchmark/benchmark.h>
+
+#include <cstdint>
+#include <random>
+#include <vector>
+
+namespace {
+struct plain_record {
+  bool          flag;
+  std::uint8_t  kind;
+  std::uint16_t offset;
+  std::uint32_t id;
+  std::uint32_t size;
+};
+using packed_record = bitpack::packed_struct<std::uint64_t,
+                                             bitpack::field<bool, 1>,
+                                             bitpack::field<std::uint8_t, 3>,
+                                             bitpack::field<std::uint16_t, 12>,
+                                             bitpack::field<std::uint32_t, 20>,
+                                             bitpack::field<std::uint32_t, 28>>;
+static_assert(sizeof(plain_record) == 12 && sizeof(packed_record) == 8);
+
+std::vector<plain_record> random_records(std::size_t const n) {
+  std::mt19937              gen{42};
+  std::vector<plain_record> records(n);
+  for(auto& r : records)
+    r = {gen() % 2 == 0,
+         static_cast<std::uint8_t>(gen() % 8),
+         static_cast<std::uint16_t>(gen() % 4096),
+         static_cast<std::uint32_t>(gen() % (1 << 20)),
+         static_cast<std::uint32_t>(gen() % (1 << 28))};
+  return records;
+}
+
+void BM_scan_plain_struct(benchmark::State& state) {
+  auto const records = random_records(state.range(0));
+  for(auto _ : state) {
+    std::size_t count = 0;
+    for(auto const& r : records) count += r.flag & (r.id < (1 << 19));
+    benchmark::DoNotOptimize(count);
+  }
+  state.SetBytesProcessed(state.iterations() * records.size()
+                          * sizeof(plain_record));
+}
+BENCHMARK(BM_scan_plain_struct)->Range(1 << 10, 1 << 22);
+
+void BM_scan_packed_struct(benchmark::State& state) {
+  std::vector<packed_record> records;
+  for(auto const& r : random_records(state.range(0)))
+    records.emplace_back(r.flag, r.kind, r.offset, r.id, r.size);
+  for(auto _ : state) {
+    std::size_t count = 0;
+    for(auto const r : records) {
+      auto const [flag, kind, offset, id, size] = r;
+      count += flag & (id < (1 << 19));
+    }
+    benchmark::DoNotOptimize(count);
+  }
+  state.SetBytesProcessed(state.iterations() * records.size()
+                          * sizeof(packed_record));
+}
+BENCHMARK(BM_scan_packed_struct)->Range(1 << 10, 1 << 22);
+} // namespace
@@ -0,0 +1,59 @@
+// Scanning 13 bit ids: packed_vector (13 bits each) vs std::vector<uint16_t>
+#include <bitpack/bitpack.hpp>
+
+#include <benchmark/benchmark.h>
+
+#include <algorithm>
+#include <cstdint>
+#include <numeric>
+#include <random>
+#include <vector>
+
+namespace {
+constexpr std::size_t id_bits = 13;
+
+template<class Vec> Vec random_ids(std::size_t const n) {
+  std::mt19937                                 gen{42};
+  std::uniform_int_distribution<std::uint16_t> dist{0, (1u << id_bits) - 1};
+  Vec                                          out;
+  out.reserve(n);
+  for(std::size_t i = 0; i < n; ++i) out.push_back(dist(gen));
+  return out;
+}
+
+void BM_scan_std_vector(benchmark::State& state) {
+  auto const ids = random_ids<std::vector<std::uint16_t>>(state.range(0));
+  for(auto _ : state)
+    benchmark::DoNotOptimize(
+        std::accumulate(ids.begin(), ids.end(), std::uint64_t{0}));
+  state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+BENCHMARK(BM_scan_std_vector)->Range(1 << 10, 1 << 20);
+
+void BM_scan_packed_vector_iterators(benchmark::State& state) {
+  using packed   = bitpack::packed_vector<std::uint16_t, id_bits>;
+  auto const ids = random_ids<packed>(state.range(0));
+  for(auto _ : state)
+    benchmark::DoNotOptimize(
+        std::accumulate(ids.begin(), ids.end(), std::uint64_t{0}));
+  state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+BENCHMARK(BM_scan_packed_vector_iterators)->Range(1 << 10, 1 << 20);
+
+void BM_scan_packed_vector_get_range(benchmark::State& state) {
+  using packed   = bitpack::packed_vector<std::uint16_t, id_bits>;
+  auto const ids = random_ids<packed>(state.range(0));
+  std::vector<std::uint16_t> chunk(256);
+  for(auto _ : state) {
+    std::uint64_t sum = 0;
+    for(std::size_t i = 0; i < ids.size(); i += chunk.size()) {
+      auto const n = std::min(chunk.size(), ids.size() - i);
+      ids.get_range(i, std::span{chunk}.first(n));
+      sum = std::accumulate(chunk.begin(), chunk.begin() + n, sum);
+    }
+    benchmark::DoNotOptimize(sum);
+  }
+  state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+BENCHMARK(BM_scan_packed_vector_get_range)->Range(1 << 10, 1 << 20);
+} // namespace
@@ -0,0 +1,241 @@
+// Microbenchmarks for the bitpack primitives against their std:: (or
+// hand-rolled) counterparts. Each benchmark walks a buffer of `count` random
+// elements so the optimizer can't constant fold the work away.
+//
+// Compare runs with google benchmark's tools/compare.py on the json output.
+#include <bitpack/bitpack.hpp>
+
+#include <benchmark/benchmark.h>
+
+#include <bit>
+#include <cstdint>
+#include <random>
+#include <utility>
+#include <variant>
+#include <vector>
+
+namespace {
+constexpr std::size_t count = 1024;
+
+template<class T> std::vector<T> random_ints(T lo, T hi) {
+  std::mt19937                     gen{42};
+  std::uniform_int_distribution<T> dist{lo, hi};
+  std::vector<T>                   out(count);
+  for(auto& x : out) x = dist(gen);
+  return out;
+}
+
+// the hand-rolled baseline: what you'd write without this library
+template<class Ptr, class Tag> struct ptr_and_tag {
+  Ptr ptr;
+  Tag tag;
+};
+
+// bits
+void BM_bits_as_UInt(benchmark::State& state) {
+  auto const xs = random_ints<int>(-1000000, 1000000);
+  for(auto _ : state)
+    for(auto const x : xs)
+      benchmark::DoNotOptimize(bitpack::bits::as_UInt<std::uint64_t>(x));
+  state.SetItemsProcessed(state.iterations() * count);
+}
+BENCHMARK(BM_bits_as_UInt);
+
+void BM_bits_from_UInt(benchmark::State& state) {
+  auto const xs = random_ints<std::uint64_t>(0, UINT32_MAX);
+  for(auto _ : state)
+    for(auto const x : xs)
+      benchmark::DoNotOptimize(bitpack::bits::from_UInt<std::uint32_t>(x));
+  state.SetItemsProcessed(state.iterations() * count);
+}
+BENCHMARK(BM_bits_from_UInt);
+
+// the non-native byte order should only cost a bswap
+void BM_bits_as_UInt_swapped(benchmark::State& state) {
+  constexpr auto swapped = std::endian::native == std::endian::little
+                               ? std::endian::big
+                               : std::endian::little;
+  auto const     xs      = random_ints<int>(-1000000, 1000000);
+  for(auto _ : state)
+    for(auto const x : xs)
+      benchmark::DoNotOptimize(
+          bitpack::bits::as_UInt<std::uint64_t, int, swapped>(x));
+  state.SetItemsProcessed(state.iterations() * count);
+}
+BENCHMARK(BM_bits_as_UInt_swapped);
+
+void BM_bits_from_UInt_swapped(benchmark::State& state) {
+  constexpr auto swapped = std::endian::native == std::endian::little
+                               ? std::endian::big
+                               : std::endian::little;
+  auto const     xs      = random_ints<std::uint64_t>(0, UINT32_MAX);
+  for(auto _ : state)
+    for(auto const x : xs)
+      benchmark::DoNotOptimize(
+          bitpack::bits::from_UInt<std::uint32_t, std::uint64_t, swapped>(x));
+  state.SetItemsProcessed(state.iterations() * count);
+}
+BENCHMARK(BM_bits_from_UInt_swapped);
+
+// pairs
+using bpk_pair = bitpack::uintptr_pair<std::uint32_t, std::uint16_t>;
+using std_pair = std::pair<std::uint32_t, std::uint16_t>;
+
+template<class Pair> std::vector<Pair> random_pairs() {
+  auto const        xs = random_ints<std::uint32_t>(0, UINT32_MAX);
+  auto const        ys = random_ints<std::uint16_t>(0, UINT16_MAX);
+  std::vector<Pair> out;
+  out.reserve(count);
+  for(std::size_t i = 0; i < count; ++i) out.emplace_back(xs[i], ys[i]);
+  return out;
+}
+
+template<class Pair> void BM_pair_construct(benchmark::State& state) {
+  auto const xs = random_ints<std::uint32_t>(0, UINT32_MAX);
+  auto const ys = random_ints<std::uint16_t>(0, UINT16_MAX);
+  for(auto _ : state)
+    for(std::size_t i = 0; i < count; ++i)
+      benchmark::DoNotOptimize(Pair(xs[i], ys[i]));
+  state.SetItemsProcessed(state.iterations() * count);
+}
+BENCHMARK_TEMPLATE(BM_pair_construct, bpk_pair);
+BENCHMARK_TEMPLATE(BM_pair_construct, std_pair);
+
+template<class Pair> void BM_pair_get(benchmark::State& state) {
+  using std::get;
+  using bitpack::get;
+  auto const pairs = random_pairs<Pair>();
+  for(auto _ : state)
+    for(auto const& p : pairs) {
+      benchmark::DoNotOptimize(get<0>(p));
+      benchmark::DoNotOptimize(get<1>(p));
+    }
+  state.SetItemsProcessed(state.iterations() * count);
+}
+BENCHMARK_TEMPLATE(BM_pair_get, bpk_pair);
+BENCHMARK_TEMPLATE(BM_pair_get, std_pair);
+
+template<class Pair> void BM_pair_compare(benchmark::State& state) {
+  auto const pairs = random_pairs<Pair>();
+  for(auto _ : state)
+    for(std::size_t i = 1; i < count; ++i)
+      benchmark::DoNotOptimize(pairs[i - 1] <=> pairs[i]);
+  state.SetItemsProcessed(state.iterations() * (count - 1));
+}
+BENCHMARK_TEMPLATE(BM_pair_compare, bpk_pair);
+BENCHMARK_TEMPLATE(BM_pair_compare, std_pair);
+
+// tagged pointers
+struct alignas(8) node {
+  std::uint64_t payload;
+};
+using bpk_tagged  = bitpack::tagged_ptr<node*, unsigned>;
+using high_tagged = bitpack::high_tagged_ptr<node*, unsigned>;
+using raw_tagged  = ptr_and_tag<node*, unsigned>;
+
+template<class Tagged>
+std::vector<Tagged> random_tagged(std::vector<node>& nodes) {
+  auto const          tags = random_ints<unsigned>(0, 7);
+  std::vector<Tagged> out;
+  out.reserve(count);
+  for(std::size_t i = 0; i < count; ++i)
+    out.push_back(Tagged{&nodes[i], tags[i]});
+  return out;
+}
+
+template<class Tagged> void BM_tagged_ptr(benchmark::State& state) {
+  std::vector<node> nodes(count);
+  auto const        tagged = random_tagged<Tagged>(nodes);
+  for(auto _ : state)
+    for(auto const& p : tagged) {
+      if constexpr(!std::is_same_v<Tagged, raw_tagged>) {
+        benchmark::DoNotOptimize(p.ptr());
+        benchmark::DoNotOptimize(p.tag());
+      } else {
+        benchmark::DoNotOptimize(p.ptr);
+        benchmark::DoNotOptimize(p.tag);
+      }
+    }
+  state.SetItemsProcessed(state.iterations() * count);
+}
+BENCHMARK_TEMPLATE(BM_tagged_ptr, bpk_tagged);
+BENCHMARK_TEMPLATE(BM_tagged_ptr, high_tagged);
+BENCHMARK_TEMPLATE(BM_tagged_ptr, raw_tagged);
+
+// variants
+struct alignas(8) circle {
+  std::uint64_t r;
+};
+struct alignas(8) square {
+  std::uint64_t side;
+};
+struct alignas(8) triangle {
+  std::uint64_t base, height;
+};
+using bpk_variant = bitpack::variant_ptr<circle*, square*, triangle*>;
+using std_variant = std::variant<circle*, square*, triangle*>;
+
+struct area {
+  std::uint64_t operator()(circle* c) const noexcept { return 3 * c->r * c->r; }
+  std::uint64_t operator()(square* s) const noexcept {
+    return s->side * s->side;
+  }
+  std::uint64_t operator()(triangle* t) const noexcept {
+    return t->base * t->height / 2;
+  }
+};
+
+template<class Variant> void BM_variant_visit(benchmark::State& state) {
+  std::vector<circle>   circles(count, circle{2});
+  std::vector<square>   squares(count, square{3});
+  std::vector<triangle> triangles(count, triangle{4, 5});
+  auto const            kinds = random_ints<int>(0, 2);
+  std::vector<Variant>  variants;
+  variants.reserve(count);
+  for(std::size_t i = 0; i < count; ++i) {
+    switch(kinds[i]) {
+      case 0: variants.emplace_back(&circles[i]); break;
+      case 1: variants.emplace_back(&squares[i]); break;
+      default: variants.emplace_back(&triangles[i]); break;
+    }
+  }
+
+  using std::visit;
+  using bitpack::visit;
+  for(auto _ : state)
+    for(auto const& v : variants) benchmark::DoNotOptimize(visit(area{}, v));
+  state.SetItemsProcessed(state.iterations() * count);
+}
+BENCHMARK_TEMPLATE(BM_variant_visit, bpk_variant);
+BENCHMARK_TEMPLATE(BM_variant_visit, std_variant);
+
+// the hand-rolled baseline for visit: a struct with a pointer and a kind
+void BM_variant_visit_raw(benchmark::State& state) {
+  std::vector<circle>                  circles(count, circle{2});
+  std::vector<square>                  squares(count, square{3});
+  std::vector<triangle>                triangles(count, triangle{4, 5});
+  auto const                           kinds = random_ints<int>(0, 2);
+  std::vector<ptr_and_tag<void*, int>> variants;
+  variants.reserve(count);
+  for(std::size_t i = 0; i < count; ++i) {
+    switch(kinds[i]) {
+      case 0: variants.push_back({&circles[i], 0}); break;
+      case 1: variants.push_back({&squares[i], 1}); break;
+      default: variants.push_back({&triangles[i], 2}); break;
+    }
+  }
+
+  for(auto _ : state)
+    for(auto const& v : variants) {
+      std::uint64_t result;
+      switch(v.tag) {
+        case 0: result = area{}(static_cast<circle*>(v.ptr)); break;
+        case 1: result = area{}(static_cast<square*>(v.ptr)); break;
+        default: result = area{}(static_cast<triangle*>(v.ptr)); break;
+      }
+      benchmark::DoNotOptimize(result);
+    }
+  state.SetItemsProcessed(state.iterations() * count);
+}
+BENCHMARK(BM_variant_visit_raw);
+} // namespace
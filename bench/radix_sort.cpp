@@ -0,0 +1,50 @@
+// radix_sort on packed words vs std::sort with the element's own comparison
+#include <bitpack/bitpack.hpp>
+
+#include <benchmark/benchmark.h>
+
+#include <algorithm>
+#include <cstdint>
+#include <random>
+#include <span>
+#include <vector>
+
+namespace {
+using pair = bitpack::ordered_pair<std::int32_t, std::uint32_t, std::uint64_t>;
+
+std::vector<pair> random_pairs(std::size_t const n) {
+  std::mt19937_64                             gen{42};
+  std::uniform_int_distribution<std::int32_t> xs{INT32_MIN, INT32_MAX};
+  std::uniform_int_distribution<std::uint32_t> ys{0, UINT32_MAX};
+  std::vector<pair>                            out;
+  out.reserve(n);
+  for(std::size_t i = 0; i < n; ++i) out.emplace_back(xs(gen), ys(gen));
+  return out;
+}
+
+void BM_sort_pairs_std_sort(benchmark::State& state) {
+  auto const pairs = random_pairs(state.range(0));
+  for(auto _ : state) {
+    state.PauseTiming();
+    auto copy = pairs;
+    state.ResumeTiming();
+    std::sort(copy.begin(), copy.end());
+    benchmark::DoNotOptimize(copy.data());
+  }
+  state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+BENCHMARK(BM_sort_pairs_std_sort)->Range(1 << 10, 1 << 22);
+
+void BM_sort_pairs_radix_sort(benchmark::State& state) {
+  auto const pairs = random_pairs(state.range(0));
+  for(auto _ : state) {
+    state.PauseTiming();
+    auto copy = pairs;
+    state.ResumeTiming();
+    bitpack::radix_sort(std::span{copy});
+    benchmark::DoNotOptimize(copy.data());
+  }
+  state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+BENCHMARK(BM_sort_pairs_radix_sort)->Range(1 << 10, 1 << 22);
+} // namespace
@@ -0,0 +1,41 @@
+// The read side of memory reclamation: pin, load a shared pointer and read
+// through it, on N threads at once. Epochs shouldn't write to shared memory
+// at all, hazard pointers write to their own slot, and shared_ptr bumps one
+// shared reference count.
+#include <bitpack/bitpack.hpp>
+
+#include <benchmark/benchmark.h>
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+
+namespace {
+struct node {
+  std::uint64_t value;
+};
+
+template<class Domain> void BM_reclaim_read(benchmark::State& state) {
+  static std::atomic<node*> shared{new node{42}};
+  auto&                     domain = Domain::global();
+  for(auto _ : state) {
+    auto guard = domain.pin();
+    benchmark::DoNotOptimize(guard.protect(0, shared)->value);
+  }
+  state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK_TEMPLATE(BM_reclaim_read, bitpack::epoch_domain)
+    ->ThreadRange(1, 8)
+    ->UseRealTime();
+BENCHMARK_TEMPLATE(BM_reclaim_read, bitpack::hazard_domain)
+    ->ThreadRange(1, 8)
+    ->UseRealTime();
+
+void BM_reclaim_read_shared_ptr(benchmark::State& state) {
+  static std::atomic<std::shared_ptr<node>> shared{std::make_shared<node>(42)};
+  for(auto _ : state)
+    benchmark::DoNotOptimize(shared.load(std::memory_order_acquire)->value);
+  state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_reclaim_read_shared_ptr)->ThreadRange(1, 8)->UseRealTime();
+} // namespace
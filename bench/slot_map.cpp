@@ -0,0 +1,63 @@
+// Looking up elements by handle: slot_map (an index and one compare) vs a
+// std::unordered_map keyed by the same 64 bit handles.
+#include <bitpack/bitpack.hpp>
+
+#include <benchmark/benchmark.h>
+
+#include <algorithm>
+#include <cstdint>
+#include <random>
+#include <unordered_map>
+#include <vector>
+
+namespace {
+struct particle {
+  float x, y, dx, dy;
+};
+
+using map_type = bitpack::slot_map<particle>;
+using handle   = map_type::handle;
+
+// n elements, with a quarter erased and reinserted so generations vary, and
+// every live handle in a random order
+map_type random_map(std::size_t const n, std::vector<handle>& handles) {
+  map_type map;
+  map.reserve(n);
+  for(std::size_t i = 0; i < n; ++i) handles.push_back(map.insert({}));
+  std::mt19937 gen{42};
+  std::ranges::shuffle(handles, gen);
+  for(auto& h : std::span{handles}.first(n / 4)) {
+    map.erase(h);
+    h = map.insert({});
+  }
+  std::ranges::shuffle(handles, gen);
+  return map;
+}
+
+void BM_lookup_slot_map(benchmark::State& state) {
+  std::vector<handle> handles;
+  auto                map = random_map(state.range(0), handles);
+  for(auto _ : state) {
+    float sum = 0;
+    for(auto const h : handles) sum += map.find(h)->x;
+    benchmark::DoNotOptimize(sum);
+  }
+  state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+BENCHMARK(BM_lookup_slot_map)->Range(1 << 10, 1 << 20);
+
+void BM_lookup_unordered_map(benchmark::State& state) {
+  std::vector<handle> handles;
+  auto const          slots = random_map(state.range(0), handles);
+  std::unordered_map<std::uint64_t, particle> map;
+  map.reserve(handles.size());
+  for(auto const h : handles) map.emplace(h.word(), slots[h]);
+  for(auto _ : state) {
+    float sum = 0;
+    for(auto const h : handles) sum += map.find(h.word())->second.x;
+    benchmark::DoNotOptimize(sum);
+  }
+  state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+BENCHMARK(BM_lookup_unordered_map)->Range(1 << 10, 1 << 20);
+} // namespace
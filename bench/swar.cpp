@@ -0,0 +1,69 @@
+// Count-min sketch updates with 8 bit saturating counters, the 4 rows of the
+// sketch packed into one 64 bit word per bucket (each row picks one of two
+// lanes). Bumping the counters one byte at a time vs all 4 at once with
+// swar::increment_saturate. Which counters each update bumps is worked out
+// up front, so this times the bumps.
+#include <bitpack/bitpack.hpp>
+
+#include <benchmark/benchmark.h>
+
+#include <array>
+#include <cstdint>
+#include <random>
+#include <vector>
+
+namespace {
+constexpr std::size_t bucket_count = 1 << 12, row_count = 4;
+
+struct update {
+  std::uint32_t                       bucket;
+  std::array<std::uint8_t, row_count> lanes;
+  std::uint64_t                       lane_mask; // top bit of each lane
+};
+
+std::vector<update> random_updates(std::size_t const n) {
+  std::mt19937_64     gen{42};
+  std::vector<update> updates(n);
+  for(auto& u : updates) {
+    auto const h = gen();
+    // skewed, so plenty of counters saturate
+    u.bucket    = static_cast<std::uint32_t>(h % (h & 1 ? 64 : bucket_count));
+    u.lane_mask = 0;
+    for(std::size_t row = 0; row < row_count; ++row) {
+      auto const lane = 2 * row + ((h >> (32 + row)) & 1);
+      u.lanes[row]    = static_cast<std::uint8_t>(lane);
+      u.lane_mask |= std::uint64_t{0x80} << (8 * lane);
+    }
+  }
+  return updates;
+}
+
+void BM_count_min_bytes(benchmark::State& state) {
+  auto const                updates = random_updates(state.range(0));
+  std::vector<std::uint8_t> sketch(bucket_count * 8);
+  for(auto _ : state) {
+    for(auto const& u : updates)
+      for(auto const lane : u.lanes) {
+        auto& counter = sketch[u.bucket * 8 + lane];
+        counter += counter != 0xFF;
+      }
+    benchmark::DoNotOptimize(sketch.data());
+  }
+  state.SetItemsProcessed(state.iterations() * updates.size());
+}
+BENCHMARK(BM_count_min_bytes)->Range(1 << 10, 1 << 20);
+
+void BM_count_min_swar(benchmark::State& state) {
+  auto const                 updates = random_updates(state.range(0));
+  std::vector<std::uint64_t> sketch(bucket_count);
+  for(auto _ : state) {
+    for(auto const& u : updates) {
+      auto& bucket = sketch[u.bucket];
+      bucket       = bitpack::swar::increment_saturate<8>(bucket, u.lane_mask);
+    }
+    benchmark::DoNotOptimize(sketch.data());
+  }
+  state.SetItemsProcessed(state.iterations() * updates.size());
+}
+BENCHMARK(BM_count_min_swar)->Range(1 << 10, 1 << 20);
+} // namespace
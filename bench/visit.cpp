@@ -0,0 +1,119 @@
+// How does the cost of variant_ptr's visit scale with the number of
+// alternatives? Small variants go through the unrolled switch, bigger ones
+// through the jump table. Both should stay flat as the size grows.
+#include <bitpack/bitpack.hpp>
+
+#include <benchmark/benchmark.h>
+
+#include <array>
+#include <cstdint>
+#include <new>
+#include <random>
+#include <utility>
+#include <variant>
+#include <vector>
+
+namespace {
+constexpr std::size_t count = 1024;
+
+// alignas(64) leaves room for a 6 bit tag (up to 64 alternatives)
+template<std::size_t I> struct alignas(64) alternative {
+  std::uint64_t value;
+};
+struct alignas(64) slot {
+  std::byte raw[sizeof(alternative<0>)];
+};
+
+template<class seq> struct variants_of;
+template<std::size_t... I> struct variants_of<std::index_sequence<I...>> {
+  using bpk_type = bitpack::variant_ptr<alternative<I>*...>;
+  using std_type = std::variant<alternative<I>*...>;
+
+  // construct an alternative<tag> in the slot and point a Variant at it
+  template<class Variant>
+  static Variant
+      emplace(std::size_t const tag, slot& at, std::uint64_t const value) {
+    using make_fn = Variant (*)(slot&, std::uint64_t);
+    static constexpr make_fn makers[] = {[](slot& s, std::uint64_t v) {
+      return Variant{new(&s) alternative<I>{v}};
+    }...};
+    return makers[tag](at, value);
+  }
+};
+
+template<class Variant, std::size_t alternatives>
+void BM_visit_scaling(benchmark::State& state) {
+  using variants = variants_of<std::make_index_sequence<alternatives>>;
+
+  std::vector<slot>                          slots(count);
+  std::vector<Variant>                       vs;
+  std::mt19937                               gen{42};
+  std::uniform_int_distribution<std::size_t> dist{0, alternatives - 1};
+  vs.reserve(count);
+  for(std::size_t i = 0; i < count; ++i)
+    vs.push_back(variants::template emplace<Variant>(dist(gen), slots[i], i));
+
+  auto const visitor = [](auto* alt) noexcept { return alt->value; };
+  using std::visit;
+  using bitpack::visit;
+  for(auto _ : state)
+    for(auto const& v : vs) benchmark::DoNotOptimize(visit(visitor, v));
+  state.SetItemsProcessed(state.iterations() * count);
+}
+
+template<std::size_t N>
+using bpk_variant =
+    typename variants_of<std::make_index_sequence<N>>::bpk_type;
+template<std::size_t N>
+using std_variant =
+    typename variants_of<std::make_index_sequence<N>>::std_type;
+
+#define BITPACK_BENCH_VISIT_SCALING(N)                                         \
+  BENCHMARK_TEMPLATE(BM_visit_scaling, bpk_variant<N>, N);                     \
+  BENCHMARK_TEMPLATE(BM_visit_scaling, std_variant<N>, N);
+BITPACK_BENCH_VISIT_SCALING(2)
+BITPACK_BENCH_VISIT_SCALING(4)
+BITPACK_BENCH_VISIT_SCALING(8)
+BITPACK_BENCH_VISIT_SCALING(16)
+BITPACK_BENCH_VISIT_SCALING(32)
+BITPACK_BENCH_VISIT_SCALING(64)
+#undef BITPACK_BENCH_VISIT_SCALING
+
+// double dispatch: one visit over both variants vs nesting single visits
+template<class Variant, bool nested>
+void BM_visit_double_dispatch(benchmark::State& state) {
+  constexpr std::size_t alternatives = 8;
+  using variants = variants_of<std::make_index_sequence<alternatives>>;
+
+  std::vector<slot>                          slots(2 * count);
+  std::vector<Variant>                       lhs, rhs;
+  std::mt19937                               gen{42};
+  std::uniform_int_distribution<std::size_t> dist{0, alternatives - 1};
+  for(std::size_t i = 0; i < count; ++i) {
+    lhs.push_back(variants::template emplace<Variant>(dist(gen), slots[i], i));
+    rhs.push_back(
+        variants::template emplace<Variant>(dist(gen), slots[count + i], i));
+  }
+
+  auto const visitor = [](auto* a, auto* b) noexcept {
+    return a->value - b->value;
+  };
+  using std::visit;
+  using bitpack::visit;
+  for(auto _ : state)
+    for(std::size_t i = 0; i < count; ++i) {
+      if constexpr(nested)
+        benchmark::DoNotOptimize(visit(
+            [&](auto* a) {
+              return visit([&](auto* b) { return visitor(a, b); }, rhs[i]);
+            },
+            lhs[i]));
+      else
+        benchmark::DoNotOptimize(visit(visitor, lhs[i], rhs[i]));
+    }
+  state.SetItemsProcessed(state.iterations() * count);
+}
+BENCHMARK_TEMPLATE(BM_visit_double_dispatch, bpk_variant<8>, false);
+BENCHMARK_TEMPLATE(BM_visit_double_dispatch, bpk_variant<8>, true);
+BENCHMARK_TEMPLATE(BM_visit_double_dispatch, std_variant<8>, false);
+} // namespace
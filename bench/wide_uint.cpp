@@ -0,0 +1,77 @@
+// Binary searching an index of (64 bit key, 40 bit offset, 24 bit length)
+// entries: a plain struct (24 bytes, padded) vs the same fields packed into
+// one unsigned __int128 (16 bytes), and into a wide_uint<2>. The packed
+// entries order by key as plain integers, so the search compares words.
+#include <bitpack/bitpack.hpp>
+
+#include <benchmark/benchmark.h>
+
+#include <algorithm>
+#include <cstdint>
+#include <random>
+#include <vector>
+
+namespace {
+struct plain_entry {
+  std::uint64_t key;
+  std::uint64_t offset;
+  std::uint32_t length;
+};
+static_assert(sizeof(plain_entry) == 24);
+
+template<class UInt>
+using packed_entry = bitpack::packed_struct<UInt,
+                                            bitpack::field<std::uint64_t>,
+                                            bitpack::field<std::uint64_t, 40>,
+                                            bitpack::field<std::uint32_t, 24>>;
+
+std::vector<plain_entry> random_index(std::size_t const n) {
+  std::mt19937_64          gen{42};
+  std::vector<plain_entry> index(n);
+  for(auto& e : index)
+    e = {gen(),
+         gen() & bitpack::bits::low_mask<std::uint64_t>(40),
+         static_cast<std::uint32_t>(gen() % (1 << 24))};
+  std::sort(index.begin(), index.end(), [](auto const& a, auto const& b) {
+    return a.key < b.key;
+  });
+  return index;
+}
+
+void BM_index_search_plain(benchmark::State& state) {
+  auto const      index = random_index(state.range(0));
+  std::mt19937_64 gen{7};
+  for(auto _ : state) {
+    auto const key = index[gen() % index.size()].key;
+    auto const it  = std::lower_bound(
+        index.begin(), index.end(), key, [](auto const& e, auto const k) {
+          return e.key < k;
+        });
+    benchmark::DoNotOptimize(it->offset);
+  }
+  state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_index_search_plain)->Range(1 << 10, 1 << 22);
+
+template<class UInt> void BM_index_search_packed(benchmark::State& state) {
+  using entry = packed_entry<UInt>;
+  std::vector<entry> index;
+  for(auto const& e : random_index(state.range(0)))
+    index.emplace_back(e.key, e.offset, e.length);
+  std::mt19937_64 gen{7};
+  for(auto _ : state) {
+    auto const probe = entry{bitpack::get<0>(index[gen() % index.size()]),
+                             0,
+                             0}; // sorts before any entry with that key
+    auto const it    = std::lower_bound(index.begin(), index.end(), probe);
+    benchmark::DoNotOptimize(bitpack::get<1>(*it));
+  }
+  state.SetItemsProcessed(state.iterations());
+}
+#if BITPACK_HAS_INT128
+BENCHMARK(BM_index_search_packed<bitpack::bits::uint128_t>)
+    ->Range(1 << 10, 1 << 22);
+#endif
+BENCHMARK(BM_index_search_packed<bitpack::bits::wide_uint<2>>)
+    ->Range(1 << 10, 1 << 22);
+} // namespace
@@ -0,0 +1,262 @@
+#ifndef BITPACK_ARENA_INCLUDE_GUARD
+#define BITPACK_ARENA_INCLUDE_GUARD
+
+#include "macros.hpp"
+#include "bits.hpp"
+
+#include <algorithm>
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <memory_resource>
+#include <new>
+#include <utility>
+
+#if defined(__unix__) || defined(__APPLE__)
+#  include <sys/mman.h>
+#  define BITPACK_ARENA_MMAP 1
+#else
+#  define BITPACK_ARENA_MMAP 0
+#endif
+
+namespace bitpack {
+/**
+ * Where an arena gets its chunks from.
+ * - normal: operator new
+ * - huge: mmap, in multiples of 2 MiB, with madvise(MADV_HUGEPAGE) so Linux
+ *   backs them with transparent huge pages (fewer TLB misses when walking big
+ *   node graphs). Same as normal where mmap isn't available.
+ */
+enum class arena_pages { normal, huge };
+
+/**
+ * A bump allocator. Allocating is a pointer increment in the current chunk,
+ * and a new chunk (twice as big as the last, up to max_chunk_size) is fetched
+ * when it runs out. Nothing is freed individually: reset() frees everything
+ * at once (and destructors are never run, so it's for trivially destructible
+ * objects, or ones whose destructors don't matter).
+ *
+ * Every allocation is aligned to at least min_align. So any pointer from an
+ * arena has tag_bits low bits free, whatever type it points to: chars and
+ * shorts can go in a tagged_ptr<T*, Tag, tag_bits> or a variant_ptr with up to
+ * 2^tag_bits alternatives.
+ *
+ * It can't back a compressed_ptr, though: that needs an OffsetBase, one
+ * region with one base address, and the chunks here are separate allocations.
+ *
+ * min_align = the alignment every allocation gets (a power of 2)
+ */
+template<std::size_t min_align = alignof(std::max_align_t)> class arena {
+  static_assert(std::has_single_bit(min_align),
+                "The minimum alignment must be a power of 2");
+
+  struct chunk {
+    chunk*      next;
+    std::size_t size;
+  };
+  static constexpr std::size_t chunk_align =
+      std::max(min_align, alignof(chunk));
+  static constexpr std::size_t huge_page_size = std::size_t{2} << 20;
+  static_assert(min_align <= huge_page_size);
+
+ public:
+  /**
+   * How many low bits of every pointer from this arena are 0
+   */
+  static constexpr std::size_t tag_bits = std::countr_zero(min_align);
+  static constexpr std::size_t alignment          = min_align;
+  static constexpr std::size_t default_chunk_size = std::size_t{64} << 10;
+  static constexpr std::size_t max_chunk_size     = std::size_t{64} << 20;
+
+  /**
+   * chunk_size = the size of the first chunk. Allocations too big for the
+   * next chunk get one of their own size.
+   */
+  explicit arena(std::size_t const chunk_size = default_chunk_size,
+                 arena_pages const pages      = arena_pages::normal) noexcept
+      : next_size_{chunk_size},
+        pages_{BITPACK_ARENA_MMAP ? pages : arena_pages::normal} {}
+  arena(arena&& other) noexcept
+      : chunks_{std::exchange(other.chunks_, nullptr)},
+        spare_{std::exchange(other.spare_, nullptr)},
+        cur_{std::exchange(other.cur_, no_chunk)},
+        end_{std::exchange(other.end_, 0)},
+        next_size_{other.next_size_},
+        pages_{other.pages_} {}
+  arena& operator=(arena&&) = delete;
+  ~arena() { release(); }
+
+  /**
+   * bytes of memory aligned to max(align, min_align). align must be a power
+   * of 2.
+   */
+  void* allocate(std::size_t const bytes,
+                 std::size_t const align = min_align) {
+    BITPACK_ASSERT(std::has_single_bit(align));
+    auto const a = std::max(align, min_align);
+    auto const p = round_up(cur_, a);
+    if(p > end_ || bytes > end_ - p) [[unlikely]]
+      return allocate_slow(bytes, a);
+    cur_ = p + bytes;
+    return bits::bit_cast<void*>(p);
+  }
+
+  /**
+   * Allocate and construct a T
+   */
+  template<class T, class... Args> T* make(Args&&... args) {
+    return ::new(allocate(sizeof(T), alignof(T)))
+        T(std::forward<Args>(args)...);
+  }
+
+  /**
+   * Free everything allocated so far, but keep the chunks to allocate from
+   * again (biggest first). An arena reused, say, once per parse stops going
+   * back to the system (and page faulting) once it's big enough.
+   */
+  void reset() noexcept {
+    if(chunks_ == nullptr) return;
+    auto* last = chunks_;
+    while(last->next != nullptr) last = last->next;
+    last->next = std::exchange(spare_, std::exchange(chunks_, nullptr));
+    cur_       = no_chunk;
+    end_       = 0;
+  }
+  /**
+   * Free everything, and give every chunk back
+   */
+  void release() noexcept {
+    free_chunks(std::exchange(chunks_, nullptr));
+    free_chunks(std::exchange(spare_, nullptr));
+    cur_ = no_chunk;
+    end_ = 0;
+  }
+
+  /**
+   * Total bytes of the chunks held (used or not)
+   */
+  std::size_t capacity() const noexcept {
+    std::size_t total = 0;
+    for(auto* c = chunks_; c != nullptr; c = c->next) total += c->size;
+    for(auto* c = spare_; c != nullptr; c = c->next) total += c->size;
+    return total;
+  }
+
+ private:
+  static constexpr std::uintptr_t round_up(std::uintptr_t const x,
+                                           std::size_t const    align) {
+    return (x + align - 1) & ~std::uintptr_t{align - 1};
+  }
+
+  void* allocate_slow(std::size_t const bytes, std::size_t const align) {
+    // (enough to align the allocation even if align > chunk_align)
+    auto const needed = sizeof(chunk) + align + bytes;
+    chunk*     c      = nullptr;
+    if(spare_ != nullptr && spare_->size >= needed) {
+      c = std::exchange(spare_, spare_->next);
+    } else {
+      c          = new_chunk(std::max(next_size_, needed));
+      next_size_ = std::min(next_size_ * 2, max_chunk_size);
+    }
+    c->next = std::exchange(chunks_, c);
+    start_in(c);
+    return allocate(bytes, align);
+  }
+
+  void start_in(chunk* const c) noexcept {
+    cur_ = bits::bit_cast<std::uintptr_t>(c) + sizeof(chunk);
+    end_ = bits::bit_cast<std::uintptr_t>(c) + c->size;
+  }
+
+  chunk* new_chunk(std::size_t size) {
+#if BITPACK_ARENA_MMAP
+    if(pages_ == arena_pages::huge) {
+      size = round_up(size, huge_page_size);
+      return ::new(map_huge(size)) chunk{nullptr, size};
+    }
+#endif
+    return ::new(::operator new(size, std::align_val_t{chunk_align}))
+        chunk{nullptr, size};
+  }
+
+  void free_chunks(chunk* c) const noexcept {
+    while(c != nullptr) {
+      auto* const next = c->next;
+      auto const  size = c->size;
+#if BITPACK_ARENA_MMAP
+      if(pages_ == arena_pages::huge) {
+        ::munmap(c, size);
+        c = next;
+        continue;
+      }
+#endif
+      ::operator delete(c, size, std::align_val_t{chunk_align});
+      c = next;
+    }
+  }
+
+#if BITPACK_ARENA_MMAP
+  // size bytes starting at a huge page boundary, so the whole range can be
+  // huge pages
+  static void* map_huge(std::size_t const size) {
+    auto const mapped = size + huge_page_size;
+    void* const p     = ::mmap(nullptr,
+                               mapped,
+                               PROT_READ | PROT_WRITE,
+                               MAP_PRIVATE | MAP_ANONYMOUS,
+                               -1,
+                               0);
+    if(p == MAP_FAILED) throw std::bad_alloc{};
+    // trim the ends that stick out past the aligned range
+    auto const begin = bits::bit_cast<std::uintptr_t>(p);
+    auto const start = round_up(begin, huge_page_size);
+    if(start != begin) ::munmap(p, start - begin);
+    if(auto const tail = huge_page_size - (start - begin))
+      ::munmap(bits::bit_cast<void*>(start + size), tail);
+#  ifdef MADV_HUGEPAGE
+    ::madvise(bits::bit_cast<void*>(start), size, MADV_HUGEPAGE);
+#  endif
+    return bits::bit_cast<void*>(start);
+  }
+#endif
+
+  // past end_, so the first allocation goes and gets a chunk
+  static constexpr std::uintptr_t no_chunk = 1;
+
+  chunk*         chunks_ = nullptr; // in use, the current one first
+  chunk*         spare_  = nullptr; // kept by reset()
+  std::uintptr_t cur_    = no_chunk;
+  std::uintptr_t end_    = 0;
+  std::size_t    next_size_;
+  arena_pages    pages_;
+};
+
+/**
+ * An arena as a std::pmr::memory_resource, so pmr containers can allocate
+ * from it. Deallocating does nothing: the memory comes back when the arena is
+ * reset.
+ */
+template<std::size_t min_align>
+class arena_resource : public std::pmr::memory_resource {
+ public:
+  explicit arena_resource(arena<min_align>& a) noexcept : arena_{&a} {}
+
+  arena<min_align>& get_arena() const noexcept { return *arena_; }
+
+ private:
+  void* do_allocate(std::size_t const bytes,
+                    std::size_t const align) override {
+    return arena_->allocate(bytes, align);
+  }
+  void do_deallocate(void*, std::size_t, std::size_t) noexcept override {}
+  bool do_is_equal(
+      std::pmr::memory_resource const& other) const noexcept override {
+    auto const* const same = dynamic_cast<arena_resource const*>(&other);
+    return same != nullptr && same->arena_ == arena_;
+  }
+
+  arena<min_align>* arena_;
+};
+} // namespace bitpack
+
+#endif // BITPACK_ARENA_INCLUDE_GUARD
@@ -0,0 +1,208 @@
+#ifndef BITPACK_ATOMIC_PACKED_INCLUDE_GUARD
+#define BITPACK_ATOMIC_PACKED_INCLUDE_GUARD
+
+#include "macros.hpp"
+#include "bits.hpp"
+#include "pair.hpp"
+#include "atomic_tagged_ptr.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <concepts>
+
+namespace bitpack {
+/**
+ * A UInt_pair that can be shared between threads, say two counters that have
+ * to change together (references and pending operations). Both elements live
+ * in one word, so they're loaded, stored and compare-exchanged together, and
+ * fetch_add_x/fetch_add_y are a single atomic add (lock xadd on x86) on the
+ * element's bits.
+ *
+ * Adding to one element must not overflow into the other (or off the top of
+ * the word). That can't be prevented without a CAS loop, but with asserts on,
+ * every fetch_add/fetch_sub checks for it afterwards.
+ *
+ * Pair = the UInt_pair to hold
+ */
+template<class Pair> class atomic_packed {
+ public:
+  using value_type  = Pair;
+  using first_type  = typename Pair::first_type;
+  using second_type = typename Pair::second_type;
+  using word_type   = typename Pair::word_type;
+  static constexpr bool is_always_lock_free =
+      std::atomic<word_type>::is_always_lock_free;
+
+ private:
+  static constexpr auto low_bit_count = Pair::low_bit_count;
+  // the biggest values that fit in each element's bits (and type)
+  static constexpr word_type x_max = bits::low_mask<word_type>(
+      std::min<std::size_t>(Pair::high_bit_count,
+                            bits::bit_sizeof<first_type>));
+  static constexpr word_type y_max = bits::low_mask<word_type>(
+      std::min<std::size_t>(low_bit_count, bits::bit_sizeof<second_type>));
+  // fetch_add needs unsigned elements, and a word std::atomic can add to
+  static constexpr bool has_fetch_add =
+      requires(std::atomic<word_type> a) { a.fetch_add(word_type{}); };
+  static constexpr bool adds_x =
+      has_fetch_add && std::unsigned_integral<first_type>;
+  static constexpr bool adds_y =
+      has_fetch_add && std::unsigned_integral<second_type>;
+
+ public:
+  /**
+   * Holds the pair whose word is all 0 bits
+   */
+  constexpr atomic_packed() noexcept : word_{0} {}
+  /**
+   * desired = the initial pair
+   */
+  explicit constexpr atomic_packed(Pair const desired) noexcept
+      : word_{desired.word()} {}
+  atomic_packed(atomic_packed const&) = delete;
+  atomic_packed& operator=(atomic_packed const&) = delete;
+
+  bool is_lock_free() const noexcept { return word_.is_lock_free(); }
+
+  Pair load(std::memory_order const order =
+                std::memory_order_seq_cst) const noexcept {
+    return Pair::from_word(word_.load(order));
+  }
+  void store(Pair const              desired,
+             std::memory_order const order =
+                 std::memory_order_seq_cst) noexcept {
+    word_.store(desired.word(), order);
+  }
+  operator Pair() const noexcept { return load(); }
+  Pair operator=(Pair const desired) noexcept {
+    store(desired);
+    return desired;
+  }
+
+  /**
+   * Replace the pair, returning the previous one.
+   */
+  Pair exchange(Pair const              desired,
+                std::memory_order const order =
+                    std::memory_order_seq_cst) noexcept {
+    return Pair::from_word(word_.exchange(desired.word(), order));
+  }
+
+  /**
+   * If the stored pair's word is == expected's, replace it with desired.
+   * Otherwise, load the stored pair into expected. Returns whether the
+   * exchange happened. The _weak version may fail spuriously.
+   */
+  bool compare_exchange_weak(Pair&                   expected,
+                             Pair const              desired,
+                             std::memory_order const success,
+                             std::memory_order const failure) noexcept {
+    return cas<true>(expected, desired, success, failure);
+  }
+  bool compare_exchange_weak(Pair&                   expected,
+                             Pair const              desired,
+                             std::memory_order const order =
+                                 std::memory_order_seq_cst) noexcept {
+    return compare_exchange_weak(expected,
+                                 desired,
+                                 order,
+                                 impl::failure_order(order));
+  }
+  bool compare_exchange_strong(Pair&                   expected,
+                               Pair const              desired,
+                               std::memory_order const success,
+                               std::memory_order const failure) noexcept {
+    return cas<false>(expected, desired, success, failure);
+  }
+  bool compare_exchange_strong(Pair&                   expected,
+                               Pair const              desired,
+                               std::memory_order const order =
+                                   std::memory_order_seq_cst) noexcept {
+    return compare_exchange_strong(expected,
+                                   desired,
+                                   order,
+                                   impl::failure_order(order));
+  }
+
+  /**
+   * Replace the pair with f(pair), in a CAS loop (so f may be called several
+   * times, and should have no side effects). Returns the previous pair.
+   */
+  template<std::invocable<Pair> F>
+  Pair update(F const                 f,
+              std::memory_order const order = std::memory_order_seq_cst) {
+    auto old = load(std::memory_order_relaxed);
+    while(!compare_exchange_weak(old, f(old), order)) {}
+    return old;
+  }
+
+  /**
+   * Add to x (or y) in one atomic add, without touching the other element.
+   * Returns the previous pair. x (y) has to be unsigned, and the sum has to
+   * fit in its bits. (Only for builtin words: std::atomic can't add
+   * bits::wide_uints.)
+   */
+  Pair fetch_add_x(first_type const        delta,
+                   std::memory_order const order = std::memory_order_seq_cst) //
+      noexcept(impl::is_assert_off) requires adds_x {
+    auto const old = Pair::from_word(word_.fetch_add(x_bits(delta), order));
+    // (otherwise x wrapped around past the top of the word)
+    BITPACK_ASSERT(word_type{delta} <= x_max - word_type{old.x()});
+    return old;
+  }
+  Pair fetch_add_y(second_type const       delta,
+                   std::memory_order const order = std::memory_order_seq_cst) //
+      noexcept(impl::is_assert_off) requires adds_y {
+    auto const old = Pair::from_word(word_.fetch_add(delta, order));
+    // (otherwise y carried into x)
+    BITPACK_ASSERT(word_type{delta} <= y_max - word_type{old.y()});
+    return old;
+  }
+  /**
+   * Subtract from x (or y) in one atomic subtraction. It mustn't go below 0.
+   */
+  Pair fetch_sub_x(first_type const        delta,
+                   std::memory_order const order = std::memory_order_seq_cst) //
+      noexcept(impl::is_assert_off) requires adds_x {
+    auto const old = Pair::from_word(word_.fetch_sub(x_bits(delta), order));
+    BITPACK_ASSERT(delta <= old.x());
+    return old;
+  }
+  Pair fetch_sub_y(second_type const       delta,
+                   std::memory_order const order = std::memory_order_seq_cst) //
+      noexcept(impl::is_assert_off) requires adds_y {
+    auto const old = Pair::from_word(word_.fetch_sub(delta, order));
+    // (otherwise y borrowed from x)
+    BITPACK_ASSERT(delta <= old.y());
+    return old;
+  }
+
+ private:
+  static constexpr word_type x_bits(first_type const x) noexcept {
+    return static_cast<word_type>(word_type{x} << low_bit_count);
+  }
+
+  template<bool weak>
+  bool cas(Pair&                   expected,
+           Pair const              desired,
+           std::memory_order const success,
+           std::memory_order const failure) noexcept {
+    auto       expected_word = expected.word();
+    bool const exchanged =
+        weak ? word_.compare_exchange_weak(expected_word,
+                                           desired.word(),
+                                           success,
+                                           failure)
+             : word_.compare_exchange_strong(expected_word,
+                                             desired.word(),
+                                             success,
+                                             failure);
+    expected = Pair::from_word(expected_word);
+    return exchanged;
+  }
+
+  std::atomic<word_type> word_;
+};
+} // namespace bitpack
+
+#endif // BITPACK_ATOMIC_PACKED_INCLUDE_GUARD
@@ -0,0 +1,193 @@
+#ifndef BITPACK_ATOMIC_TAGGED_PTR_INCLUDE_GUARD
+#define BITPACK_ATOMIC_TAGGED_PTR_INCLUDE_GUARD
+
+#include "macros.hpp"
+#include "bits.hpp"
+#include "tagged_ptr.hpp"
+
+#include <atomic>
+#include <cstdint>
+
+namespace bitpack {
+namespace impl {
+// compare_exchange's failure order can't release anything (there was no
+// store), so drop the release half of the success order.
+inline constexpr std::memory_order
+    failure_order(std::memory_order const order) noexcept {
+  switch(order) {
+    case std::memory_order_acq_rel: return std::memory_order_acquire;
+    case std::memory_order_release: return std::memory_order_relaxed;
+    default: return order;
+  }
+}
+} // namespace impl
+
+/**
+ * A tagged_ptr that can be shared between threads. The pointer and the tag
+ * live in a single word, so both are loaded, stored, and compare-exchanged
+ * together in one lock-free operation (no double-width CAS needed).
+ *
+ * The template parameters are the same as tagged_ptr's.
+ */
+template<class Ptr,
+         class Tag,
+         size_t tag_bits_ = std::bit_width(alignof(traits::unptr_t<Ptr>) - 1),
+         uintptr_t ptr_replacement_bits = 0u,
+         class Storage = tag_storage::low<tag_bits_, ptr_replacement_bits>>
+class atomic_tagged_ptr {
+ public:
+  using value_type =
+      tagged_ptr<Ptr, Tag, tag_bits_, ptr_replacement_bits, Storage>;
+  static constexpr bool is_always_lock_free =
+      std::atomic<uintptr_t>::is_always_lock_free;
+
+  /**
+   * Holds a null pointer with a tag of all 0 bits.
+   */
+  constexpr atomic_tagged_ptr() noexcept : word_{0} {}
+  /**
+   * desired = the initial pointer and tag
+   */
+  explicit constexpr atomic_tagged_ptr(value_type const desired) noexcept
+      : word_{to_word(desired)} {}
+  atomic_tagged_ptr(atomic_tagged_ptr const&) = delete;
+  atomic_tagged_ptr& operator=(atomic_tagged_ptr const&) = delete;
+
+  bool is_lock_free() const noexcept { return word_.is_lock_free(); }
+
+  value_type load(std::memory_order const order =
+                      std::memory_order_seq_cst) const noexcept {
+    return from_word(word_.load(order));
+  }
+  void store(value_type const       desired,
+             std::memory_order const order =
+                 std::memory_order_seq_cst) noexcept {
+    word_.store(to_word(desired), order);
+  }
+  operator value_type() const noexcept { return load(); }
+  value_type operator=(value_type const desired) noexcept {
+    store(desired);
+    return desired;
+  }
+
+  /**
+   * Replace the pointer and tag, returning the previous ones.
+   */
+  value_type exchange(value_type const       desired,
+                      std::memory_order const order =
+                          std::memory_order_seq_cst) noexcept {
+    return from_word(word_.exchange(to_word(desired), order));
+  }
+
+  /**
+   * If the stored pointer and tag are both == expected, replace them with
+   * desired. Otherwise, load the stored ones into expected. Returns whether the
+   * exchange happened. The _weak version may fail spuriously.
+   */
+  bool compare_exchange_weak(value_type&             expected,
+                             value_type const        desired,
+                             std::memory_order const success,
+                             std::memory_order const failure) noexcept {
+    return cas<true>(expected, desired, success, failure);
+  }
+  bool compare_exchange_weak(value_type&             expected,
+                             value_type const        desired,
+                             std::memory_order const order =
+                                 std::memory_order_seq_cst) noexcept {
+    return compare_exchange_weak(expected,
+                                 desired,
+                                 order,
+                                 impl::failure_order(order));
+  }
+  bool compare_exchange_strong(value_type&             expected,
+                               value_type const        desired,
+                               std::memory_order const success,
+                               std::memory_order const failure) noexcept {
+    return cas<false>(expected, desired, success, failure);
+  }
+  bool compare_exchange_strong(value_type&             expected,
+                               value_type const        desired,
+                               std::memory_order const order =
+                                   std::memory_order_seq_cst) noexcept {
+    return compare_exchange_strong(expected,
+                                   desired,
+                                   order,
+                                   impl::failure_order(order));
+  }
+
+  /**
+   * Replace the tag but keep the pointer. Returns the previous pointer and tag.
+   */
+  value_type fetch_set_tag(Tag const               tag,
+                           std::memory_order const order =
+                               std::memory_order_seq_cst) //
+      noexcept(impl::is_assert_off) {
+    return fetch_update(
+        [tag](value_type const old) { return old.with_tag(tag); },
+        order);
+  }
+  /**
+   * Replace the pointer but keep the tag. Returns the previous pointer and tag.
+   */
+  value_type fetch_set_ptr(Ptr const               ptr,
+                           std::memory_order const order =
+                               std::memory_order_seq_cst) //
+      noexcept(impl::is_assert_off) {
+    return fetch_update(
+        [ptr](value_type const old) { return old.with_ptr(ptr); },
+        order);
+  }
+
+ private:
+  static constexpr uintptr_t to_word(value_type const x) noexcept {
+    return value_type::word(x);
+  }
+  static constexpr value_type from_word(uintptr_t const x) noexcept {
+    return value_type::from_word(x);
+  }
+
+  template<bool weak>
+  bool cas(value_type&             expected,
+           value_type const        desired,
+           std::memory_order const success,
+           std::memory_order const failure) noexcept {
+    auto       expected_word = to_word(expected);
+    bool const exchanged =
+        weak ? word_.compare_exchange_weak(expected_word,
+                                           to_word(desired),
+                                           success,
+                                           failure)
+             : word_.compare_exchange_strong(expected_word,
+                                             to_word(desired),
+                                             success,
+                                             failure);
+    expected = from_word(expected_word);
+    return exchanged;
+  }
+
+  // CAS loop: replace the stored value with f(stored value)
+  value_type fetch_update(auto const f, std::memory_order const order) {
+    auto old = load(std::memory_order_relaxed);
+    while(!compare_exchange_weak(old, f(old), order)) {}
+    return old;
+  }
+
+  std::atomic<uintptr_t> word_;
+};
+
+template<class Ptr, class Tag, size_t tag_bits = 16>
+using atomic_high_tagged_ptr =
+    atomic_tagged_ptr<Ptr, Tag, tag_bits, 0u, tag_storage::high<tag_bits>>;
+template<class Ptr,
+         class Tag,
+         size_t high_bits = 16,
+         size_t low_bits = std::bit_width(alignof(traits::unptr_t<Ptr>) - 1)>
+using atomic_high_low_tagged_ptr =
+    atomic_tagged_ptr<Ptr,
+                      Tag,
+                      high_bits + low_bits,
+                      0u,
+                      tag_storage::high_low<high_bits, low_bits>>;
+} // namespace bitpack
+
+#endif // BITPACK_ATOMIC_TAGGED_PTR_INCLUDE_GUARD
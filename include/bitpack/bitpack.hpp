@@ -4,9 +4,28 @@
 #include "bits.hpp"
 #include "macros.hpp"
 #include "pair.hpp"
+#include "packed_struct.hpp"
 #include "tagged_ptr.hpp"
+#include "atomic_tagged_ptr.hpp"
+#include "atomic_packed.hpp"
 #include "variant_ptr.hpp"
+#include "unique_variant_ptr.hpp"
+#include "derived_variant_ptr.hpp"
+#include "nan_box.hpp"
+#include "compressed_ptr.hpp"
+#include "arena.hpp"
 #include "niebloids.hpp"
 #include "maybe_get.hpp"
+#include "radix_sort.hpp"
+#include "packed_vector.hpp"
+#include "slot_map.hpp"
+#include "bulk.hpp"
+#include "swar.hpp"
+#include "lockfree_stack.hpp"
+#include "lockfree_queue.hpp"
+#include "reclaim.hpp"
+#include "epoch_domain.hpp"
+#include "hazard_domain.hpp"
+#include "lockfree_set.hpp"
 
 #endif // BITPACK_INCLUDE_GUARD
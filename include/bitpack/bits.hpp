@@ -8,7 +8,17 @@
 #include <array>
 #include <cstring>
 #include <bit>
+#include <compare>
 #include <concepts>
+#include <cstddef>
+#include <type_traits>
+#include <utility>
+
+#if defined(__SIZEOF_INT128__)
+#  define BITPACK_HAS_INT128 1
+#else
+#  define BITPACK_HAS_INT128 0
+#endif
 
 namespace bitpack { namespace bits {
 
@@ -54,43 +64,380 @@ template<std::integral T> inline constexpr T to_integer(auto const x) noexcept {
   return static_cast<T>(x);
 }
 
+#if BITPACK_HAS_INT128
+// (__extension__ so -pedantic doesn't complain)
+__extension__ typedef unsigned __int128 uint128_t;
+#endif
+
+template<std::size_t N> class wide_uint;
+
+namespace impl {
+// in strict (non-gnu) mode, __int128 isn't std::integral
+template<class T> inline constexpr bool is_uint128 = false;
+#if BITPACK_HAS_INT128
+template<> inline constexpr bool is_uint128<uint128_t> = true;
+#endif
+template<class T>
+concept builtin_integer = std::integral<T> || is_uint128<T>;
+
+template<class T> inline constexpr bool is_wide_uint = false;
+template<std::size_t N>
+inline constexpr bool is_wide_uint<wide_uint<N>> = true;
+} // namespace impl
+
+/**
+ * What bits can be packed into: the unsigned integer types, unsigned __int128
+ * (where the compiler has it) and wide_uint
+ */
+template<class T>
+concept unsigned_word = std::unsigned_integral<T> || impl::is_uint128<T>
+                        || impl::is_wide_uint<T>;
+
+/**
+ * An unsigned integer made of N 64 bit words, to pack more bits than the
+ * builtin types hold. It has what packing needs: conversions, the bitwise
+ * operators, shifts and comparisons (no arithmetic). words()[0] is the least
+ * significant word, and a shift moves bits across words, so packed fields can
+ * straddle them.
+ *
+ * Like the builtin types, integers convert to it implicitly (negative ones
+ * sign extend) and it converts back explicitly (keeping the low bits).
+ */
+template<std::size_t N> class wide_uint {
+  static_assert(N > 0, "A wide_uint needs a word");
+
+ public:
+  using words_type                  = std::array<std::uint64_t, N>;
+  static constexpr std::size_t size = N;
+
+  constexpr wide_uint() = default;
+  template<impl::builtin_integer I>
+  constexpr wide_uint(I const x) noexcept {
+    if constexpr(std::is_signed_v<I>)
+      if(x < 0) words_.fill(~std::uint64_t{0});
+    words_[0] = static_cast<std::uint64_t>(x);
+    if constexpr(sizeof(I) > sizeof(std::uint64_t) && N > 1)
+      words_[1] = static_cast<std::uint64_t>(x >> 64);
+  }
+  explicit constexpr wide_uint(words_type const& words) noexcept
+      : words_{words} {}
+
+  constexpr words_type const& words() const noexcept { return words_; }
+
+  template<impl::builtin_integer I>
+  requires(!std::is_same_v<I, bool>) //
+      explicit constexpr operator I() const noexcept {
+    if constexpr(sizeof(I) > sizeof(std::uint64_t) && N > 1)
+      return static_cast<I>((static_cast<I>(words_[1]) << 64) | words_[0]);
+    else
+      return static_cast<I>(words_[0]);
+  }
+  explicit constexpr operator bool() const noexcept {
+    for(auto const w : words_)
+      if(w != 0) return true;
+    return false;
+  }
+
+  friend constexpr wide_uint operator~(wide_uint x) noexcept {
+    for(auto& w : x.words_) w = ~w;
+    return x;
+  }
+#define BITPACK_WIDE_BITWISE(op)                                             \
+    friend constexpr wide_uint& operator op##=(wide_uint&       a,             \
+                                               wide_uint const& b) noexcept {  \
+      for(std::size_t i = 0; i < N; ++i) a.words_[i] op## = b.words_[i];       \
+      return a;                                                                \
+    }                                                                          \
+    friend constexpr wide_uint operator op(wide_uint a,                        \
+                                           wide_uint const& b) noexcept {      \
+      return a op## = b;                                                       \
+    }
+  BITPACK_WIDE_BITWISE(&)
+  BITPACK_WIDE_BITWISE(|)
+  BITPACK_WIDE_BITWISE(^)
+#undef BITPACK_WIDE_BITWISE
+
+  friend constexpr wide_uint operator<<(wide_uint const&  x,
+                                        std::size_t const n) noexcept {
+    wide_uint  out;
+    auto const skip = n / 64, shift = n % 64;
+    for(auto i = skip; i < N; ++i) {
+      out.words_[i] = x.words_[i - skip] << shift;
+      if(shift != 0 && i > skip)
+        out.words_[i] |= x.words_[i - skip - 1] >> (64 - shift);
+    }
+    return out;
+  }
+  friend constexpr wide_uint operator>>(wide_uint const&  x,
+                                        std::size_t const n) noexcept {
+    wide_uint  out;
+    auto const skip = n / 64, shift = n % 64;
+    for(std::size_t i = 0; i + skip < N; ++i) {
+      out.words_[i] = x.words_[i + skip] >> shift;
+      if(shift != 0 && i + skip + 1 < N)
+        out.words_[i] |= x.words_[i + skip + 1] << (64 - shift);
+    }
+    return out;
+  }
+  friend constexpr wide_uint& operator<<=(wide_uint&        x,
+                                          std::size_t const n) noexcept {
+    return x = x << n;
+  }
+  friend constexpr wide_uint& operator>>=(wide_uint&        x,
+                                          std::size_t const n) noexcept {
+    return x = x >> n;
+  }
+
+  friend constexpr bool operator==(wide_uint const&,
+                                   wide_uint const&) noexcept = default;
+  friend constexpr std::strong_ordering
+      operator<=>(wide_uint const& a, wide_uint const& b) noexcept {
+    for(auto i = N; i-- > 0;)
+      if(a.words_[i] != b.words_[i]) return a.words_[i] <=> b.words_[i];
+    return std::strong_ordering::equal;
+  }
+
+ private:
+  words_type words_{};
+};
+
+// polyfill: std::byteswap is C++23
+template<class UInt>
+requires(std::unsigned_integral<UInt> || impl::is_uint128<UInt>) //
+    inline constexpr UInt byteswap(UInt const x) noexcept {
+#if defined(__cpp_lib_byteswap)
+  return std::byteswap(x);
+#elif defined(__GNUC__) || defined(__clang__)
+  if constexpr(sizeof(UInt) == 1)
+    return x;
+  else if constexpr(sizeof(UInt) == 2)
+    return __builtin_bswap16(x);
+  else if constexpr(sizeof(UInt) == 4)
+    return __builtin_bswap32(x);
+  else if constexpr(sizeof(UInt) == 16)
+    return (UInt{__builtin_bswap64(static_cast<std::uint64_t>(x))} << 64)
+           | __builtin_bswap64(static_cast<std::uint64_t>(x >> 64));
+  else {
+    static_assert(sizeof(UInt) == 8);
+    return __builtin_bswap64(x);
+  }
+#else
+  auto bytes = bytes_of(x);
+  for(auto i = 0u; i < bytes.size() / 2; ++i)
+    std::swap(bytes[i], bytes[bytes.size() - i - 1]);
+  return bits::bit_cast<UInt>(bytes);
+#endif
+}
+
+namespace impl {
+// the unsigned integer exactly `size` bytes wide (void if there isn't one)
+template<std::size_t size> struct exact_uint {
+  using type = void;
+};
+template<> struct exact_uint<1> {
+  using type = std::uint8_t;
+};
+template<> struct exact_uint<2> {
+  using type = std::uint16_t;
+};
+template<> struct exact_uint<4> {
+  using type = std::uint32_t;
+};
+template<> struct exact_uint<8> {
+  using type = std::uint64_t;
+};
+#if BITPACK_HAS_INT128
+template<> struct exact_uint<16> {
+  using type = uint128_t;
+};
+#endif
+template<std::size_t size>
+using exact_uint_t = typename exact_uint<size>::type;
+
+// Can T <-> UInt go through one bit_cast (and a byteswap) instead of a loop?
+template<class T, class UInt>
+inline constexpr bool has_fast_UInt_path =
+    !std::is_void_v<exact_uint_t<sizeof(T)>> && sizeof(T) <= sizeof(UInt);
+} // namespace impl
+
 /**
  * Given a `T`, return (a copy of) its underlying bytes as a `UInt`
+ * endian = the order to read the bytes of `x` in: with little, the first byte
+ * ends up in the lowest bits of the result.
  */
-// ENDIAN??????
-template<std::unsigned_integral UInt,
-         class T,
-         std::endian endian = std::endian::native>
+template<unsigned_word UInt, class T, std::endian endian = std::endian::native>
 inline constexpr UInt as_UInt(T const x) noexcept {
   static_assert(endian == std::endian::little || endian == std::endian::big);
-  auto const bytes = bytes_of(x);
-  UInt       acc{};
-  auto const size = bytes.size();
-  for(auto i = 0u; i < size; ++i) {
-    auto const lookup_idx =
-        (endian == std::endian::little) ? i : (size - i - 1);
-    auto const this_byte = to_integer<UInt>(bytes[lookup_idx]);
-    acc |= (this_byte << (i * CHAR_BIT));
-  }
-  return acc;
+  if constexpr(impl::has_fast_UInt_path<T, UInt>) {
+    // once optimized, that's one mov (plus a bswap for the other endianness)
+    auto const u = bits::bit_cast<impl::exact_uint_t<sizeof(T)>>(x);
+    if constexpr(endian == std::endian::native)
+      return static_cast<UInt>(u);
+    else
+      return static_cast<UInt>(bits::byteswap(u));
+  } else {
+    auto const bytes = bytes_of(x);
+    UInt       acc{};
+    auto const size = bytes.size();
+    for(auto i = 0u; i < size; ++i) {
+      auto const lookup_idx =
+          (endian == std::endian::little) ? i : (size - i - 1);
+      auto const this_byte =
+          static_cast<UInt>(to_integer<unsigned char>(bytes[lookup_idx]));
+      acc |= (this_byte << (i * CHAR_BIT));
+    }
+    return acc;
+  }
 }
 
 /**
  * Unpack the underlying bits in a `UInt` back to `To`
  */
 template<class To,
-         std::unsigned_integral From,
-         std::endian            endian = std::endian::native>
+         unsigned_word From,
+         std::endian   endian = std::endian::native>
 inline constexpr auto from_UInt(From const from) noexcept {
-  std::array<std::byte, sizeof(To)> bytes;
-  auto const                        size = bytes.size();
-  for(auto i = 0u; i < size; ++i) {
-    auto const byte_idx = (endian == std::endian::little) ? i : (size - i - 1);
-    bytes[byte_idx]     = narrow<std::byte>((from >> (i * CHAR_BIT)) & UCHAR_MAX);
+  if constexpr(impl::has_fast_UInt_path<To, From>) {
+    auto const u = static_cast<impl::exact_uint_t<sizeof(To)>>(from);
+    if constexpr(endian == std::endian::native)
+      return bits::bit_cast<To>(u);
+    else
+      return bits::bit_cast<To>(bits::byteswap(u));
+  } else {
+    std::array<std::byte, sizeof(To)> bytes;
+    auto const                        size = bytes.size();
+    for(auto i = 0u; i < size; ++i) {
+      auto const byte_idx =
+          (endian == std::endian::little) ? i : (size - i - 1);
+      bytes[byte_idx] = static_cast<std::byte>(
+          static_cast<unsigned char>(from >> (i * CHAR_BIT)));
+    }
+    return bits::bit_cast<To>(bytes);
   }
-  return bits::bit_cast<To>(bytes);
 }
 
+/**
+ * A UInt with the lowest `width` bits set
+ */
+template<unsigned_word UInt>
+inline constexpr UInt low_mask(std::size_t const width) noexcept {
+  if constexpr(impl::is_wide_uint<UInt>)
+    return ~(~UInt{} << width); // (no subtraction, but shifts saturate)
+  else
+    return width >= bit_sizeof<UInt>
+               ? static_cast<UInt>(~UInt{0})
+               : static_cast<UInt>((UInt{1} << width) - 1);
+}
+
+namespace impl {
+template<class T, bool = std::is_enum_v<T>> struct underlying {
+  using type = T;
+};
+template<class T> struct underlying<T, true> {
+  using type = std::underlying_type_t<T>;
+};
+// enums act like their underlying type
+template<class T> using underlying_t = typename underlying<T>::type;
+
+// for packing's postconditions: did `in` come back out of its bits? (NaNs
+// aren't == to themselves, but do come back)
+template<class T>
+constexpr bool round_trips(T const out, T const in) noexcept {
+  if constexpr(std::floating_point<T>)
+    if(in != in) return out != out;
+  return out == in;
+}
+} // namespace impl
+
+/**
+ * Encodings say how a value of type T is stored in the low `width` bits of a
+ * UInt and how to get it back out.
+ *
+ * preserves_order<T> = comparing the encoded bits as unsigned numbers orders
+ * them the same as comparing the values.
+ * preserves_equality<T> = the encoded bits are equal exactly when the values
+ * are.
+ */
+struct raw_encoding {
+  template<unsigned_word UInt, std::size_t width, class T>
+  static constexpr UInt encode(T const x) noexcept {
+    return as_UInt<UInt>(x) & low_mask<UInt>(width);
+  }
+  template<class T, std::size_t width, unsigned_word UInt>
+  static constexpr T decode(UInt const x) noexcept {
+    return from_UInt<T>(x);
+  }
+
+  template<class T>
+  static constexpr bool preserves_order =
+      unsigned_word<impl::underlying_t<T>>;
+  template<class T>
+  static constexpr bool preserves_equality =
+      std::integral<impl::underlying_t<T>> || unsigned_word<T>
+      || std::is_pointer_v<T>;
+};
+
+/**
+ * An encoding that keeps the order of signed and floating point values, so
+ * packed words can be compared as plain unsigned integers.
+ * - unsigned values are stored as they are
+ * - signed values get their sign bit flipped (offset binary)
+ * - floating point values are stored as IEEE 754 total order keys: flip the
+ *   sign bit of positives and every bit of negatives. This orders -0.0 before
+ *   +0.0 and NaNs at the ends, like std::strong_order.
+ */
+struct ordered_encoding {
+ private:
+  template<class T>
+  static constexpr bool is_signed = std::signed_integral<impl::underlying_t<T>>;
+
+ public:
+  template<unsigned_word UInt, std::size_t width, class T>
+  static constexpr UInt encode(T const x) noexcept {
+    static_assert(sizeof(T) <= sizeof(UInt));
+    constexpr UInt sign = UInt{1} << (width - 1);
+    UInt           u    = as_UInt<UInt>(x);
+    if constexpr(std::floating_point<T>) {
+      static_assert(width == bit_sizeof<T>,
+                    "Floating point values must be stored at full width");
+      return (u & sign) ? static_cast<UInt>(~u & low_mask<UInt>(width))
+                        : static_cast<UInt>(u | sign);
+    } else if constexpr(is_signed<T>) {
+      // sign extend to the UInt so wider fields stay in order
+      if((u >> (bit_sizeof<T> - 1)) & 1u) u |= ~low_mask<UInt>(bit_sizeof<T>);
+      return static_cast<UInt>((u & low_mask<UInt>(width)) ^ sign);
+    } else {
+      return u & low_mask<UInt>(width);
+    }
+  }
+  template<class T, std::size_t width, unsigned_word UInt>
+  static constexpr T decode(UInt u) noexcept {
+    constexpr UInt sign = UInt{1} << (width - 1);
+    if constexpr(std::floating_point<T>) {
+      return from_UInt<T>(
+          (u & sign) ? static_cast<UInt>(u ^ sign)
+                     : static_cast<UInt>(~u & low_mask<UInt>(width)));
+    } else if constexpr(is_signed<T>) {
+      u ^= sign;
+      if(u & sign) u |= ~low_mask<UInt>(width);
+      return from_UInt<T>(u);
+    } else {
+      return from_UInt<T>(u);
+    }
+  }
+
+  // for floating point, this is IEEE 754's total order, not operator<
+  template<class T>
+  static constexpr bool preserves_order = std::integral<impl::underlying_t<T>>
+                                          || unsigned_word<T>
+                                          || std::floating_point<T>;
+  // not floating point: -0.0 == +0.0 but their keys differ (so do NaNs')
+  template<class T>
+  static constexpr bool preserves_equality =
+      std::integral<impl::underlying_t<T>> || unsigned_word<T>
+      || std::is_pointer_v<T>;
+};
+
 inline constexpr auto as_uintptr_t(auto const x) noexcept {
   return as_UInt<std::uintptr_t>(x);
 }
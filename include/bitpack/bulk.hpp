@@ -0,0 +1,227 @@
+#ifndef BITPACK_BULK_INCLUDE_GUARD
+#define BITPACK_BULK_INCLUDE_GUARD
+
+#include "macros.hpp"
+#include "pair.hpp"
+#include "tagged_ptr.hpp"
+
+#include <cstddef>
+#include <span>
+#include <type_traits>
+
+namespace bitpack {
+namespace impl {
+// The kernels are plain loops over the packed words: a shift and a mask per
+// element, which compilers vectorize well. What they can't do on their own is
+// use instructions the build doesn't target, so we compile the same loop for
+// several instruction sets and pick the best one the CPU has at runtime.
+enum class simd_level { baseline, avx2, avx512 };
+
+inline simd_level best_simd_level() noexcept {
+#if BITPACK_SIMD_DISPATCH
+  static simd_level const level = [] {
+    __builtin_cpu_init();
+    if(__builtin_cpu_supports("avx512f") && __builtin_cpu_supports("avx512bw")
+       && __builtin_cpu_supports("avx512vl"))
+      return simd_level::avx512;
+    if(__builtin_cpu_supports("avx2")) return simd_level::avx2;
+    return simd_level::baseline;
+  }();
+  return level;
+#else
+  return simd_level::baseline;
+#endif
+}
+
+template<class Pair>
+inline void unpack_kernel(Pair const* const                        pairs,
+                          typename Pair::first_type* const __restrict  xs,
+                          typename Pair::second_type* const __restrict ys,
+                          std::size_t const n) noexcept {
+  for(std::size_t i = 0; i < n; ++i) {
+    xs[i] = Pair::x(pairs[i]);
+    ys[i] = Pair::y(pairs[i]);
+  }
+}
+template<class Pair>
+inline void pack_kernel(typename Pair::first_type const* const  xs,
+                        typename Pair::second_type const* const ys,
+                        Pair* const __restrict                  pairs,
+                        std::size_t const n) noexcept(is_assert_off) {
+  for(std::size_t i = 0; i < n; ++i) pairs[i] = Pair{xs[i], ys[i]};
+}
+
+// words[i] = (words[i] & keep) | set, for anything with word/from_word
+template<class T, class Word>
+inline void mask_or_kernel(T* const __restrict xs,
+                           std::size_t const   n,
+                           Word const          keep,
+                           Word const          set) noexcept {
+  for(std::size_t i = 0; i < n; ++i)
+    xs[i] = T::from_word(static_cast<Word>((T::word(xs[i]) & keep) | set));
+}
+
+// On x86-64 the baseline is SSE2, so the baseline build is the SSE2 path.
+#if BITPACK_SIMD_DISPATCH
+template<class Pair>
+BITPACK_TARGET("avx2")
+void unpack_avx2(Pair const* const                pairs,
+                 typename Pair::first_type* const  xs,
+                 typename Pair::second_type* const ys,
+                 std::size_t const                 n) noexcept {
+  unpack_kernel(pairs, xs, ys, n);
+}
+template<class Pair>
+BITPACK_TARGET("avx512f,avx512bw,avx512vl")
+void unpack_avx512(Pair const* const                pairs,
+                   typename Pair::first_type* const  xs,
+                   typename Pair::second_type* const ys,
+                   std::size_t const                 n) noexcept {
+  unpack_kernel(pairs, xs, ys, n);
+}
+template<class Pair>
+BITPACK_TARGET("avx2")
+void pack_avx2(typename Pair::first_type const* const  xs,
+               typename Pair::second_type const* const ys,
+               Pair* const                             pairs,
+               std::size_t const n) noexcept(is_assert_off) {
+  pack_kernel(xs, ys, pairs, n);
+}
+template<class Pair>
+BITPACK_TARGET("avx512f,avx512bw,avx512vl")
+void pack_avx512(typename Pair::first_type const* const  xs,
+                 typename Pair::second_type const* const ys,
+                 Pair* const                             pairs,
+                 std::size_t const n) noexcept(is_assert_off) {
+  pack_kernel(xs, ys, pairs, n);
+}
+template<class T, class Word>
+BITPACK_TARGET("avx2")
+void mask_or_avx2(T* const          xs,
+                  std::size_t const n,
+                  Word const        keep,
+                  Word const        set) noexcept {
+  mask_or_kernel(xs, n, keep, set);
+}
+template<class T, class Word>
+BITPACK_TARGET("avx512f,avx512bw,avx512vl")
+void mask_or_avx512(T* const          xs,
+                    std::size_t const n,
+                    Word const        keep,
+                    Word const        set) noexcept {
+  mask_or_kernel(xs, n, keep, set);
+}
+#endif
+
+template<class T, class Word>
+inline void
+    mask_or(std::span<T> const xs, Word const keep, Word const set) noexcept {
+#if BITPACK_SIMD_DISPATCH
+  switch(impl::best_simd_level()) {
+    case impl::simd_level::avx512:
+      return impl::mask_or_avx512(xs.data(), xs.size(), keep, set);
+    case impl::simd_level::avx2:
+      return impl::mask_or_avx2(xs.data(), xs.size(), keep, set);
+    case impl::simd_level::baseline: break;
+  }
+#endif
+  impl::mask_or_kernel(xs.data(), xs.size(), keep, set);
+}
+} // namespace impl
+
+/**
+ * Split packed pairs into a column of xs and a column of ys:
+ * xs[i] = pairs[i].x() and ys[i] = pairs[i].y().
+ * xs and ys must be at least as long as pairs and must not overlap it.
+ *
+ * Uses the widest vector instructions the CPU supports (see
+ * BITPACK_SIMD_DISPATCH).
+ */
+template<class P>
+inline void unpack(
+    std::span<P> const                                            pairs,
+    std::span<typename std::remove_const_t<P>::first_type> const  xs,
+    std::span<typename std::remove_const_t<P>::second_type> const ys) //
+    noexcept(impl::is_assert_off) {
+  using Pair = std::remove_const_t<P>;
+  BITPACK_ASSERT(xs.size() >= pairs.size() && ys.size() >= pairs.size());
+  Pair const* const in = pairs.data();
+  auto const        n  = pairs.size();
+#if BITPACK_SIMD_DISPATCH
+  switch(impl::best_simd_level()) {
+    case impl::simd_level::avx512:
+      return impl::unpack_avx512(in, xs.data(), ys.data(), n);
+    case impl::simd_level::avx2:
+      return impl::unpack_avx2(in, xs.data(), ys.data(), n);
+    case impl::simd_level::baseline: break;
+  }
+#endif
+  impl::unpack_kernel(in, xs.data(), ys.data(), n);
+}
+
+/**
+ * Zip a column of xs and a column of ys into packed pairs:
+ * pairs[i] = Pair{xs[i], ys[i]}.
+ * xs and ys must be at least as long as pairs and must not overlap it.
+ *
+ * Uses the widest vector instructions the CPU supports (see
+ * BITPACK_SIMD_DISPATCH).
+ */
+template<class Pair>
+inline void pack(std::span<typename Pair::first_type const> const  xs,
+                 std::span<typename Pair::second_type const> const ys,
+                 std::span<Pair> const pairs) noexcept(impl::is_assert_off) {
+  BITPACK_ASSERT(xs.size() >= pairs.size() && ys.size() >= pairs.size());
+  auto const n = pairs.size();
+#if BITPACK_SIMD_DISPATCH
+  switch(impl::best_simd_level()) {
+    case impl::simd_level::avx512:
+      return impl::pack_avx512(xs.data(), ys.data(), pairs.data(), n);
+    case impl::simd_level::avx2:
+      return impl::pack_avx2(xs.data(), ys.data(), pairs.data(), n);
+    case impl::simd_level::baseline: break;
+  }
+#endif
+  impl::pack_kernel(xs.data(), ys.data(), pairs.data(), n);
+}
+
+/**
+ * pairs[i] = pairs[i].with_x(x) for every pair: one mask and one or per
+ * element, vectorized like unpack.
+ */
+template<class Pair>
+inline void set_xs(std::span<Pair> const           pairs,
+                   typename Pair::first_type const x) noexcept(
+    impl::is_assert_off) {
+  using UInt      = typename Pair::word_type;
+  auto const set  = Pair::from_word(0).with_x(x).word();
+  auto const keep = bits::low_mask<UInt>(Pair::low_bit_count);
+  impl::mask_or(pairs, keep, set);
+}
+/**
+ * pairs[i] = pairs[i].with_y(y) for every pair
+ */
+template<class Pair>
+inline void set_ys(std::span<Pair> const            pairs,
+                   typename Pair::second_type const y) noexcept(
+    impl::is_assert_off) {
+  using UInt      = typename Pair::word_type;
+  auto const set  = Pair::from_word(0).with_y(y).word();
+  auto const keep =
+      static_cast<UInt>(~bits::low_mask<UInt>(Pair::low_bit_count));
+  impl::mask_or(pairs, keep, set);
+}
+/**
+ * ptrs[i].set_tag(tag) for every pointer, say to mark every object reachable
+ * from a root set in a garbage collector. One mask and one or per element.
+ */
+template<class TaggedPtr>
+inline void set_tags(std::span<TaggedPtr> const          ptrs,
+                     typename TaggedPtr::tag_type const tag) noexcept(
+    impl::is_assert_off) {
+  auto const set = TaggedPtr::from_word(0).with_tag(tag).word();
+  impl::mask_or(ptrs, ~TaggedPtr::tag_mask, set);
+}
+} // namespace bitpack
+
+#endif // BITPACK_BULK_INCLUDE_GUARD
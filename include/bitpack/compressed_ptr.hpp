@@ -0,0 +1,271 @@
+#ifndef BITPACK_COMPRESSED_PTR_INCLUDE_GUARD
+#define BITPACK_COMPRESSED_PTR_INCLUDE_GUARD
+
+#include "macros.hpp"
+#include "traits.hpp"
+#include "bits.hpp"
+#include "variant_ptr.hpp"
+
+#include <algorithm>
+#include <bit>
+#include <concepts>
+#include <cstddef>
+#include <cstdint>
+#include <type_traits>
+
+namespace bitpack {
+/**
+ * Where compressed pointers point into: a class with a static base() that
+ * returns the start of one contiguous region of memory. Compressed pointers
+ * store their offset from it instead of an address.
+ *
+ * (Not to be confused with arena.hpp's arena, which isn't one: its chunks are
+ * separate allocations, with no one base to measure offsets from. A
+ * compressed_ptr needs memory reserved up front, say a big static buffer or
+ * one mmap, with objects placed in it.)
+ */
+template<class A> concept OffsetBase = requires {
+  { A::base() } -> std::convertible_to<void const*>;
+};
+
+namespace impl {
+// alignof, but void counts as 1
+template<class T>
+inline constexpr std::size_t align_of =
+    alignof(std::conditional_t<std::is_void_v<T>, char, T>);
+
+/**
+ * Pointers into A, stored as offsets from A::base() in units of 2^shift
+ * bytes, plus one so that 0 can be null. offset_bits = how many bits the
+ * offset gets.
+ */
+template<OffsetBase A, std::size_t shift_, std::size_t offset_bits>
+struct arena_offset {
+  static constexpr std::size_t shift = shift_;
+  static_assert(0 < offset_bits && offset_bits <= 32,
+                "Offsets are at most 32 bits");
+  static constexpr std::uint32_t max =
+      bits::low_mask<std::uint32_t>(offset_bits);
+
+  static std::uintptr_t base() noexcept {
+    return bits::bit_cast<std::uintptr_t>(
+        static_cast<void const*>(A::base()));
+  }
+  static std::uint32_t compress(void const* const p) noexcept(is_assert_off) {
+    if(p == nullptr) return 0;
+    auto const offset = bits::bit_cast<std::uintptr_t>(p) - base();
+    BITPACK_ASSERT(bits::bit_cast<std::uintptr_t>(p) >= base());
+    BITPACK_ASSERT(offset % (std::uintptr_t{1} << shift) == 0);
+    BITPACK_ASSERT((offset >> shift) < max);
+    return static_cast<std::uint32_t>((offset >> shift) + 1);
+  }
+  static void* decompress(std::uint32_t const offset) noexcept {
+    if(offset == 0) return nullptr;
+    return bits::bit_cast<void*>(base()
+                                 + (std::uintptr_t{offset - 1} << shift));
+  }
+};
+} // namespace impl
+
+/**
+ * A pointer to a T inside the arena A, in 32 bits. It stores the offset from
+ * A::base() divided by T's alignment (the low bits a tagged_ptr would put a
+ * tag in are always 0, so they're shifted out instead), so it reaches
+ * 2^32 * alignof(T) bytes: 32 GiB for 8 byte aligned nodes. Every T it points
+ * to must be in that range.
+ *
+ * Compressing costs a subtract and a shift, decompressing a shift and an add,
+ * plus a branch each to keep null as 0.
+ *
+ * T = the pointee type
+ * A = where it points into (see OffsetBase)
+ */
+template<class T, OffsetBase A> class compressed_ptr {
+  // A node can point to its own type, which isn't complete yet. Nested classes
+  // are only instantiated once they're used, so alignof(T) waits until then.
+  struct offset
+      : impl::arena_offset<A, std::countr_zero(impl::align_of<T>), 32> {};
+
+ public:
+  using element_type = T;
+  using arena_type   = A;
+  /**
+   * How many bytes past A::base() this can point to
+   */
+  static constexpr std::uint64_t reach() noexcept {
+    return std::uint64_t{offset::max} << offset::shift;
+  }
+
+  constexpr compressed_ptr() = default;
+  constexpr compressed_ptr(std::nullptr_t) noexcept : word_{0} {}
+  compressed_ptr(T* const ptr) noexcept(impl::is_assert_off)
+      : word_{offset::compress(ptr)} {}
+
+  /**
+   * returns the pointer stored
+   */
+  T* get() const noexcept {
+    return static_cast<T*>(offset::decompress(word_));
+  }
+  operator T*() const noexcept { return get(); }
+  T* operator->() const noexcept { return get(); }
+  T& operator*() const noexcept requires(!std::is_void_v<T>) {
+    return *get();
+  }
+
+  /**
+   * The offset (in units of alignof(T), plus one) that's stored
+   */
+  constexpr std::uint32_t word() const noexcept { return word_; }
+  /**
+   * Reinterpret bits (as returned by word()) as a compressed_ptr
+   */
+  constexpr static compressed_ptr
+      from_word(std::uint32_t const word) noexcept {
+    compressed_ptr self;
+    self.word_ = word;
+    return self;
+  }
+
+  friend constexpr bool operator==(compressed_ptr const a,
+                                   compressed_ptr const b) noexcept {
+    return a.word_ == b.word_;
+  }
+  friend constexpr bool operator==(compressed_ptr const p,
+                                   std::nullptr_t) noexcept {
+    return p.word_ == 0;
+  }
+  constexpr explicit operator bool() const noexcept { return word_ != 0; }
+
+ private:
+  std::uint32_t word_;
+};
+
+/**
+ * A variant_ptr whose pointers all point into the arena A, in 32 bits. The
+ * low tag_bits bits hold the index and the rest hold the offset from
+ * A::base(), divided by the smallest alignment among the Ts. So unlike
+ * variant_ptr, the alternatives don't need spare alignment bits for the tag,
+ * but they must lie within 2^(32 - tag_bits) * (that alignment) bytes of the
+ * base.
+ *
+ * It has the same interface as variant_ptr (get, holds_alternative, visit,
+ * ...). visit always goes through the jump table.
+ *
+ * A = where it points into (see OffsetBase)
+ * Ts = the pointer types it can hold
+ */
+template<OffsetBase A, class... Ts> class compressed_variant_ptr {
+  using types = impl::typelist<Ts...>;
+
+ public:
+  static constexpr auto size     = types::size;
+  static constexpr auto tag_bits = std::bit_width(types::size - 1);
+  using Tag                      = int;
+  using arena_type               = A;
+
+ private:
+  // (nested so alignof waits until the Ts are complete, see compressed_ptr)
+  struct offset
+      : impl::arena_offset<A,
+                           std::countr_zero(std::min(
+                               {impl::align_of<traits::unptr_t<Ts>>...})),
+                           32 - tag_bits> {};
+  static constexpr std::uint32_t tag_mask =
+      bits::low_mask<std::uint32_t>(tag_bits);
+
+  template<class Func>
+  static constexpr bool is_visit_noexcept =
+      impl::is_visit_noexcept_by_seq<compressed_variant_ptr,
+                                     Func,
+                                     std::index_sequence_for<Ts...>>::value;
+
+  template<class Func>
+  using visit_common_type = typename impl::visit_common_type_by_seq<
+      compressed_variant_ptr,
+      Func,
+      std::index_sequence_for<Ts...>>::type;
+
+ public:
+  /**
+   * How many bytes past A::base() this can point to
+   */
+  static constexpr std::uint64_t reach() noexcept {
+    return std::uint64_t{offset::max} << offset::shift;
+  }
+
+  static constexpr Tag index(compressed_variant_ptr const self) noexcept {
+    return static_cast<Tag>(self.word_ & tag_mask);
+  }
+  constexpr Tag index() const noexcept { return index(*this); }
+
+  /**
+   * The packed bits (offset and tag)
+   */
+  static constexpr std::uint32_t
+      word(compressed_variant_ptr const self) noexcept {
+    return self.word_;
+  }
+  constexpr std::uint32_t word() const noexcept { return word(*this); }
+
+  constexpr compressed_variant_ptr() = default;
+  template<class T>
+  compressed_variant_ptr(T const ptr) noexcept(impl::is_assert_off)
+      : word_{(offset::compress(ptr) << tag_bits) | types::template find<T>} {}
+
+  template<Tag N>
+  static auto get(compressed_variant_ptr const self) noexcept(
+      impl::is_assert_off) -> typename types::template nth<N> {
+    static_assert(0 <= N && N < size, "The variant index is out of bounds");
+    using T = typename types::template nth<N>;
+    return get<T>(self);
+  }
+  template<class T>
+  static auto get(compressed_variant_ptr const self) noexcept(
+      impl::is_assert_off) -> T {
+    static_assert(types::template has<T>, "That type is not in this variant");
+    BITPACK_ASSERT(holds_alternative<T>(self));
+    return static_cast<T>(offset::decompress(self.word_ >> tag_bits));
+  }
+
+  template<class T>
+  static constexpr bool
+      holds_alternative(compressed_variant_ptr const self) noexcept {
+    return index(self) == types::template find<T>;
+  }
+
+  constexpr friend bool operator==(compressed_variant_ptr const p,
+                                   std::nullptr_t) noexcept {
+    return (p.word_ >> tag_bits) == 0;
+  }
+  constexpr explicit operator bool() const noexcept {
+    return !(*this == nullptr);
+  }
+
+  template<class R, class Func>
+  static R visit(Func                         visitor,
+                 compressed_variant_ptr const self) noexcept(
+      is_visit_noexcept<Func>) {
+    BITPACK_ASSERT(index(self) < bits::narrow<int>(size));
+    return impl::visit_table<R,
+                             Func,
+                             compressed_variant_ptr,
+                             std::index_sequence_for<Ts...>>::visit(visitor,
+                                                                    self);
+  }
+  template<class Func>
+  static auto visit(Func visitor, compressed_variant_ptr const self)
+      BITPACK_EXPR_BODY(visit<visit_common_type<Func>, Func>(visitor, self))
+
+ private:
+  std::uint32_t word_;
+};
+
+namespace impl {
+// so several can be visited at once, and mixed with variant_ptrs
+template<OffsetBase A, class... Ts>
+inline constexpr bool is_variant_ptr<compressed_variant_ptr<A, Ts...>> = true;
+} // namespace impl
+} // namespace bitpack
+
+#endif // BITPACK_COMPRESSED_PTR_INCLUDE_GUARD
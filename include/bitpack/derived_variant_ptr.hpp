@@ -0,0 +1,192 @@
+#ifndef BITPACK_DERIVED_VARIANT_PTR_INCLUDE_GUARD
+#define BITPACK_DERIVED_VARIANT_PTR_INCLUDE_GUARD
+
+#include "macros.hpp"
+#include "tagged_ptr.hpp"
+#include "variant_ptr.hpp"
+
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <type_traits>
+
+namespace bitpack {
+/**
+ * A pointer to a Base whose dynamic type is one of a closed set of classes,
+ * with that type's index kept in the pointer's low bits. It's variant_ptr for
+ * class hierarchies: visit calls the visitor with a pointer to the concrete
+ * class, without virtual functions, and is<T>() answers what dynamic_cast
+ * would, in O(1), without RTTI.
+ *
+ * The stored pointer is the Base subobject's address, so Base's alignment must
+ * leave tag_bits low bits free (otherwise, construct explicitly and make sure
+ * the objects are aligned enough, say with a bitpack::arena). Derived classes
+ * can't inherit Base virtually, since getting them back is a static_cast.
+ *
+ * The alternatives only need to be complete once a derived_variant_ptr is
+ * made or used, so nodes can link to each other with it.
+ *
+ * Base = the common base class
+ * Derived = the concrete classes it can point to (Base itself can be one)
+ */
+template<class Base, class... Derived> class derived_variant_ptr {
+  static_assert(sizeof...(Derived) <= 64, "At most 64 alternatives");
+  using types     = impl::typelist<Derived...>;
+  using self_type = derived_variant_ptr; // for BITPACK_UNROLL_VISIT
+
+ public:
+  static constexpr auto size     = types::size;
+  static constexpr auto tag_bits = std::bit_width(types::size - 1);
+  using Tag                      = int;
+  using base_type                = Base;
+
+ private:
+  // bit i is set if alternative i is a T (or derives from it)
+  template<class T>
+  static constexpr std::uint64_t alternatives_of = [] {
+    std::uint64_t mask = 0, bit = 1;
+    ((mask |= std::is_base_of_v<T, Derived> ? bit : 0, bit <<= 1), ...);
+    return mask;
+  }();
+
+ public:
+  static constexpr Tag index(derived_variant_ptr const self) noexcept {
+    return self.ptr_.tag();
+  }
+  constexpr Tag index() const noexcept { return index(*this); }
+
+  /**
+   * The packed bits (pointer and tag)
+   */
+  static constexpr uintptr_t word(derived_variant_ptr const self) noexcept {
+    return self.ptr_.word();
+  }
+  constexpr uintptr_t word() const noexcept { return word(*this); }
+
+  constexpr derived_variant_ptr() = default;
+  template<class D>
+  explicit(alignof(Base) < (std::size_t{1} << tag_bits))
+      // same as variant_ptr: if Base's alignment doesn't leave room for the
+      // tag, the caller has to vouch for the address
+      constexpr derived_variant_ptr(D* const ptr) noexcept(impl::is_assert_off)
+      : ptr_{static_cast<Base*>(ptr), types::template find<D>} {
+    static_assert((... && std::is_base_of_v<Base, Derived>),
+                  "Every alternative must derive from Base");
+  }
+
+  /**
+   * The object, as a Base. No dispatch needed.
+   */
+  constexpr Base* base() const noexcept { return ptr_.ptr(); }
+  constexpr Base* operator->() const noexcept { return base(); }
+
+  template<Tag N>
+  static constexpr auto get(derived_variant_ptr const self) noexcept(
+      impl::is_assert_off) -> typename types::template nth<N>* {
+    static_assert(0 <= N && N < size, "The variant index is out of bounds");
+    return get<typename types::template nth<N>>(self);
+  }
+  /**
+   * The object as a D. It has to be a D.
+   */
+  template<class D>
+  static constexpr D* get(derived_variant_ptr const self) noexcept(
+      impl::is_assert_off) {
+    static_assert(types::template has<D>, "That type is not in this variant");
+    BITPACK_ASSERT(holds_alternative<D>(self));
+    return static_cast<D*>(self.base());
+  }
+
+  template<class D>
+  static constexpr bool
+      holds_alternative(derived_variant_ptr const self) noexcept {
+    return index(self) == types::template find<D>;
+  }
+
+  /**
+   * Is the object a T, or of a class derived from T? T doesn't have to be one
+   * of the alternatives (say, an intermediate base class). A null pointer
+   * isn't anything, whatever its tag. A shift, a mask and a null check.
+   */
+  template<class T> constexpr bool is() const noexcept {
+    return base() != nullptr && ((alternatives_of<T> >> index()) & 1u);
+  }
+  /**
+   * The object as a T if it is one (see is), otherwise nullptr. Like
+   * dynamic_cast<T*>, but without RTTI. If T is above or below Base in the
+   * hierarchy, that's a static_cast. A cross cast (to another base class of
+   * the alternatives) has to visit, since the adjustment depends on the
+   * concrete class.
+   */
+  template<class T> constexpr T* as() const noexcept {
+    if(!is<T>()) return nullptr;
+    if constexpr(std::is_base_of_v<Base, T> || std::is_base_of_v<T, Base>)
+      return static_cast<T*>(base());
+    else
+      return visit(
+          []<class D>(D* const d) -> T* {
+            if constexpr(std::is_base_of_v<T, D>)
+              return d;
+            else
+              return nullptr;
+          },
+          *this);
+  }
+
+  constexpr friend bool operator==(derived_variant_ptr const p,
+                                   std::nullptr_t) noexcept {
+    return p.ptr_ == nullptr;
+  }
+  constexpr explicit operator bool() const noexcept {
+    return !(*this == nullptr);
+  }
+
+ private:
+  template<class Func>
+  static constexpr bool is_visit_noexcept =
+      impl::is_visit_noexcept_by_seq<derived_variant_ptr,
+                                     Func,
+                                     std::make_index_sequence<size>>::value;
+
+  template<class Func>
+  using visit_common_type = typename impl::visit_common_type_by_seq<
+      derived_variant_ptr,
+      Func,
+      std::make_index_sequence<size>>::type;
+
+  tagged_ptr<Base*, Tag, tag_bits> ptr_;
+
+ public:
+  // the same visit as variant_ptr: a switch for small hierarchies, so the
+  // visitor is inlined into each case, and a jump table for bigger ones
+  BITPACK_WRETURN_OFF
+    BITPACK_REPEAT_OUTER(BITPACK_UNROLL_VISIT, BITPACK_UNROLL_VISIT_LIMIT)
+  BITPACK_DIAGNOSTIC_POP
+
+  template<class R, class Func>
+  requires(size >= BITPACK_UNROLL_VISIT_LIMIT) //
+      static constexpr R
+      visit(Func                      visitor,
+            derived_variant_ptr const self) noexcept(is_visit_noexcept<Func>) {
+    BITPACK_ASSERT(0 <= index(self) && index(self) < bits::narrow<int>(size));
+    return impl::visit_table<R,
+                             Func,
+                             derived_variant_ptr,
+                             std::make_index_sequence<size>>::visit(visitor,
+                                                                    self);
+  }
+
+  template<class Func>
+  static constexpr auto visit(Func visitor, derived_variant_ptr const self)
+      BITPACK_EXPR_BODY(visit<visit_common_type<Func>, Func>(visitor, self))
+};
+
+namespace impl {
+// so several can be visited at once, and mixed with variant_ptrs
+template<class Base, class... Derived>
+inline constexpr bool is_variant_ptr<derived_variant_ptr<Base, Derived...>> =
+    true;
+} // namespace impl
+} // namespace bitpack
+
+#endif // BITPACK_DERIVED_VARIANT_PTR_INCLUDE_GUARD
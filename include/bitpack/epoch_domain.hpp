@@ -0,0 +1,204 @@
+#ifndef BITPACK_EPOCH_DOMAIN_INCLUDE_GUARD
+#define BITPACK_EPOCH_DOMAIN_INCLUDE_GUARD
+
+#include "macros.hpp"
+#include "reclaim.hpp"
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <utility>
+
+namespace bitpack {
+/**
+ * Epoch-based reclamation (Fraser, "Practical lock-freedom", 2004).
+ *
+ * There's a global epoch counter. A thread announces the epoch it saw when it
+ * pins (enters an operation). Objects retired during epoch e go on the
+ * retiring thread's own list for e. The epoch only moves from e to e+1 once
+ * every pinned thread has announced e, so once it reaches e+2, nobody can be
+ * pinned from before those objects were unlinked, and the list for e is
+ * freed.
+ *
+ * Pinning is a store and a fence, protect is a plain load: readers never
+ * write to shared memory (compare with shared_ptr's reference counts). The
+ * catch is that one thread that stays pinned holds up all reclamation.
+ */
+class epoch_domain {
+  struct record {
+    std::atomic<bool>          in_use{true};
+    record*                    next = nullptr;
+    std::atomic<std::uint64_t> state{0}; // (announced epoch << 1) | pinned
+
+    // the rest belongs to the thread that owns the record
+    struct limbo_list {
+      std::uint64_t  epoch = 0;
+      impl::retired* list  = nullptr;
+    };
+    unsigned                  pins = 0; // guards alive (they nest)
+    std::array<limbo_list, 3> limbo{};  // indexed by epoch % 3
+    std::size_t               retired_since_advance = 0;
+
+    void release() noexcept {}
+    ~record() {
+      for(auto const& l : limbo) impl::retired::free_all(l.list);
+    }
+  };
+
+ public:
+  /**
+   * Try to move the epoch along after this many retires on one thread
+   */
+  static constexpr std::size_t advance_every = 64;
+
+  /**
+   * Keeps objects this thread can see alive: while a guard exists, nothing
+   * retired after it was made gets freed. Guards nest.
+   */
+  class guard {
+   public:
+    guard(guard&& other) noexcept
+        : domain_{std::exchange(other.domain_, nullptr)},
+          record_{other.record_} {}
+    guard& operator=(guard&&) = delete;
+    ~guard() {
+      if(domain_ != nullptr) domain_->unpin(*record_);
+    }
+
+    /**
+     * Load src. What it points to stays alive as long as the guard does.
+     * (The slot is only for compatibility with hazard pointers.)
+     */
+    template<class Atomic>
+    auto protect(std::size_t, Atomic const& src) const noexcept {
+      return src.load(std::memory_order_acquire);
+    }
+
+   private:
+    friend epoch_domain;
+    guard(epoch_domain* const domain, record* const r) noexcept
+        : domain_{domain}, record_{r} {}
+    epoch_domain* domain_;
+    record*       record_;
+  };
+
+  epoch_domain() = default;
+  epoch_domain(epoch_domain const&) = delete;
+  epoch_domain& operator=(epoch_domain const&) = delete;
+  /**
+   * Frees everything still retired. No guards may be alive.
+   */
+  ~epoch_domain() = default;
+
+  /**
+   * A domain for anyone to share
+   */
+  static epoch_domain& global() {
+    static epoch_domain domain;
+    return domain;
+  }
+
+  guard pin() {
+    auto& r = records_.local();
+    if(r.pins++ == 0) {
+      // announce an epoch that's still current after the announcement is
+      // visible, so the epoch can't get 2 ahead of us
+      auto e = epoch_.load(std::memory_order_relaxed);
+      while(true) {
+        r.state.store((e << 1) | 1, std::memory_order_seq_cst);
+        auto const now = epoch_.load(std::memory_order_seq_cst);
+        if(now == e) break;
+        e = now;
+      }
+    }
+    return guard{this, &r};
+  }
+
+  /**
+   * p was unlinked: delete it once no guard can still see it. Tagged pointers
+   * have their tags stripped first.
+   */
+  void retire(auto const p) {
+    auto const g = pin();
+    auto&      r = *g.record_;
+    auto const e = epoch_.load(std::memory_order_acquire);
+    auto&      l = r.limbo[e % 3];
+    if(l.epoch != e) {
+      // same slot, so 3 or more epochs old: nothing can see those anymore
+      impl::retired::free_all(std::exchange(l.list, nullptr));
+      l.epoch = e;
+    }
+    auto* const item = impl::retired::make(p);
+    item->next       = std::exchange(l.list, item);
+
+    if(++r.retired_since_advance >= advance_every) {
+      r.retired_since_advance = 0;
+      try_advance();
+      collect(r);
+    }
+  }
+
+  /**
+   * The current epoch
+   */
+  std::uint64_t epoch() const noexcept {
+    return epoch_.load(std::memory_order_acquire);
+  }
+
+  /**
+   * Move the epoch along if every pinned thread has seen the current one.
+   * Returns whether it moved.
+   */
+  bool try_advance() noexcept {
+    auto e                  = epoch_.load(std::memory_order_seq_cst);
+    bool everyone_caught_up = true;
+    records_.for_each([&](record const& r) {
+      auto const state = r.state.load(std::memory_order_seq_cst);
+      if((state & 1) && (state >> 1) != e) everyone_caught_up = false;
+    });
+    return everyone_caught_up
+           && epoch_.compare_exchange_strong(e,
+                                             e + 1,
+                                             std::memory_order_seq_cst);
+  }
+
+ private:
+  void unpin(record& r) noexcept {
+    if(--r.pins == 0)
+      r.state.store(r.state.load(std::memory_order_relaxed) & ~std::uint64_t{1},
+                    std::memory_order_release);
+  }
+  // free this thread's lists that are 2 or more epochs old
+  void collect(record& r) noexcept {
+    auto const e = epoch_.load(std::memory_order_acquire);
+    for(auto& l : r.limbo)
+      if(l.list != nullptr && l.epoch + 2 <= e)
+        impl::retired::free_all(std::exchange(l.list, nullptr));
+  }
+
+  std::atomic<std::uint64_t>    epoch_{0};
+  impl::thread_registry<record> records_;
+};
+
+/**
+ * A Reclaimer (see reclaim.hpp) that uses an epoch_domain: the global one
+ * unless you pass another. It's just a pointer, so structures can share
+ * a domain.
+ */
+class epoch_reclaimer {
+ public:
+  using guard = epoch_domain::guard;
+
+  epoch_reclaimer() noexcept : domain_{&epoch_domain::global()} {}
+  explicit epoch_reclaimer(epoch_domain& domain) noexcept : domain_{&domain} {}
+
+  guard pin() const { return domain_->pin(); }
+  void  retire(auto const p) const { domain_->retire(p); }
+
+ private:
+  epoch_domain* domain_;
+};
+} // namespace bitpack
+
+#endif // BITPACK_EPOCH_DOMAIN_INCLUDE_GUARD
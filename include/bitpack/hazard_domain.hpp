@@ -0,0 +1,176 @@
+#ifndef BITPACK_HAZARD_DOMAIN_INCLUDE_GUARD
+#define BITPACK_HAZARD_DOMAIN_INCLUDE_GUARD
+
+#include "macros.hpp"
+#include "reclaim.hpp"
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <utility>
+#include <vector>
+
+namespace bitpack {
+/**
+ * Hazard pointers (Michael, "Hazard Pointers: Safe Memory Reclamation for
+ * Lock-Free Objects", 2004).
+ *
+ * Each thread has a few slots where it publishes the addresses it's about to
+ * read. A retired object is only freed once no slot holds its address. Unlike
+ * epochs, a stalled thread only holds up the (at most `slots`) objects it has
+ * published, but every protect is a store, a fence and a reload.
+ */
+class hazard_domain {
+ public:
+  /**
+   * Hazard pointers per thread
+   */
+  static constexpr std::size_t slots = 3;
+  /**
+   * Scan the hazard pointers once a thread has this many retired objects
+   */
+  static constexpr std::size_t scan_every = 64;
+
+ private:
+  struct record {
+    std::atomic<bool>                           in_use{true};
+    record*                                     next = nullptr;
+    std::array<std::atomic<void const*>, slots> hazards{};
+
+    // the rest belongs to the thread that owns the record
+    bool           guarded       = false;
+    impl::retired* retired       = nullptr;
+    std::size_t    retired_count = 0;
+
+    void release() noexcept {
+      for(auto& h : hazards) h.store(nullptr, std::memory_order_release);
+    }
+    ~record() { impl::retired::free_all(retired); }
+  };
+
+ public:
+  /**
+   * Owns this thread's hazard pointer slots. One guard per thread at a time.
+   */
+  class guard {
+   public:
+    guard(guard&& other) noexcept : record_{std::exchange(other.record_, {})} {}
+    guard& operator=(guard&&) = delete;
+    ~guard() {
+      if(record_ == nullptr) return;
+      record_->release();
+      record_->guarded = false;
+    }
+
+    /**
+     * Load src and publish what it points to in hazard pointer `slot`. It
+     * stays alive until the slot is used again or the guard is destroyed.
+     */
+    template<class Atomic>
+    auto protect(std::size_t const slot, Atomic const& src) noexcept(
+        impl::is_assert_off) {
+      BITPACK_ASSERT(slot < slots);
+      auto& hazard = record_->hazards[slot];
+      auto  value  = src.load(std::memory_order_relaxed);
+      while(true) {
+        hazard.store(impl::address_of(value), std::memory_order_seq_cst);
+        // still there after publishing? then a scan will see the hazard
+        auto const again = src.load(std::memory_order_acquire);
+        if(impl::same_bits(again, value)) return again;
+        value = again;
+      }
+    }
+
+   private:
+    friend hazard_domain;
+    explicit guard(record* const r) noexcept : record_{r} {}
+    record* record_;
+  };
+
+  hazard_domain() = default;
+  hazard_domain(hazard_domain const&) = delete;
+  hazard_domain& operator=(hazard_domain const&) = delete;
+  /**
+   * Frees everything still retired. No guards may be alive.
+   */
+  ~hazard_domain() = default;
+
+  /**
+   * A domain for anyone to share
+   */
+  static hazard_domain& global() {
+    static hazard_domain domain;
+    return domain;
+  }
+
+  guard pin() noexcept(impl::is_assert_off) {
+    auto& r = records_.local();
+    BITPACK_ASSERT(!r.guarded);
+    r.guarded = true;
+    return guard{&r};
+  }
+
+  /**
+   * p was unlinked: delete it once no hazard pointer holds it. Tagged
+   * pointers have their tags stripped first.
+   */
+  void retire(auto const p) {
+    auto&       r    = records_.local();
+    auto* const item = impl::retired::make(p);
+    item->next       = std::exchange(r.retired, item);
+    if(++r.retired_count >= scan_every) scan(r);
+  }
+
+ private:
+  // free r's retired objects that no hazard pointer holds
+  void scan(record& r) {
+    std::vector<void const*> hazards;
+    records_.for_each([&](record const& other) {
+      for(auto const& h : other.hazards)
+        if(auto const p = h.load(std::memory_order_seq_cst))
+          hazards.push_back(p);
+    });
+    std::ranges::sort(hazards);
+
+    impl::retired* keep = nullptr;
+    r.retired_count     = 0;
+    for(auto* item = std::exchange(r.retired, nullptr); item != nullptr;) {
+      auto* const next = item->next;
+      if(std::ranges::binary_search(hazards, item->ptr)) {
+        item->next = std::exchange(keep, item);
+        ++r.retired_count;
+      } else {
+        item->deleter(item->ptr);
+        delete item;
+      }
+      item = next;
+    }
+    r.retired = keep;
+  }
+
+  impl::thread_registry<record> records_;
+};
+
+/**
+ * A Reclaimer (see reclaim.hpp) that uses a hazard_domain: the global one
+ * unless you pass another. It's just a pointer, so structures can share
+ * a domain.
+ */
+class hazard_reclaimer {
+ public:
+  using guard = hazard_domain::guard;
+
+  hazard_reclaimer() noexcept : domain_{&hazard_domain::global()} {}
+  explicit hazard_reclaimer(hazard_domain& domain) noexcept
+      : domain_{&domain} {}
+
+  guard pin() const { return domain_->pin(); }
+  void  retire(auto const p) const { domain_->retire(p); }
+
+ private:
+  hazard_domain* domain_;
+};
+} // namespace bitpack
+
+#endif // BITPACK_HAZARD_DOMAIN_INCLUDE_GUARD
@@ -0,0 +1,199 @@
+#ifndef BITPACK_LOCKFREE_QUEUE_INCLUDE_GUARD
+#define BITPACK_LOCKFREE_QUEUE_INCLUDE_GUARD
+
+#include "macros.hpp"
+#include "bits.hpp"
+#include "atomic_tagged_ptr.hpp"
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <type_traits>
+
+namespace bitpack {
+/**
+ * A lock-free multi-producer, multi-consumer FIFO queue (Michael & Scott,
+ * "Simple, Fast, and Practical Non-Blocking and Blocking Concurrent Queue
+ * Algorithms", 1996).
+ *
+ * As in the paper, head, tail and every node's next link are counted
+ * pointers: an atomic_high_low_tagged_ptr whose tag counts modifications, so
+ * a single word CAS fails if the link was changed and changed back (ABA).
+ *
+ * Dequeued nodes go on an internal free list and are reused by later
+ * enqueues; they're freed when the queue is destroyed. A dequeuer may read the
+ * value of a node that's being reused (and then fail its CAS and retry), which
+ * is why T must be trivially copyable. The value is kept in a std::atomic<T>,
+ * so the queue is only lock-free if that is (see is_always_lock_free).
+ */
+template<class T> class lockfree_queue {
+  static_assert(std::is_trivially_copyable_v<T>,
+                "Dequeuers may read a value while it's being overwritten, so "
+                "it must be trivially copyable");
+
+  // node isn't complete yet, so spell out its alignment (and low tag bits)
+  static constexpr std::size_t node_align_bits = 3;
+  struct node;
+  using atomic_link =
+      atomic_high_low_tagged_ptr<node*, std::uint32_t, 16, node_align_bits>;
+  using link = typename atomic_link::value_type;
+  struct alignas(1 << node_align_bits) node {
+    atomic_link    next;
+    std::atomic<T> value;
+  };
+
+ public:
+  using value_type = T;
+  /**
+   * How many bits each link's modification count has. It wraps around, so
+   * ABA is only missed if a link changes exactly a multiple of 2^count_bits
+   * times between one thread's load and CAS.
+   */
+  static constexpr std::size_t count_bits = link::tag_bits;
+  static constexpr bool        is_always_lock_free =
+      atomic_link::is_always_lock_free && std::atomic<T>::is_always_lock_free;
+
+  lockfree_queue() {
+    // head and tail point to a dummy node: the one before the front
+    node* const dummy = new node;
+    head_.store(link{dummy, 0});
+    tail_.store(link{dummy, 0});
+  }
+  lockfree_queue(lockfree_queue const&) = delete;
+  lockfree_queue& operator=(lockfree_queue const&) = delete;
+  ~lockfree_queue() {
+    for(node* n = head_.load().ptr(); n != nullptr;) {
+      node* const next = n->next.load().ptr();
+      delete n;
+      n = next;
+    }
+    for(node* n = free_.load().ptr(); n != nullptr;) {
+      node* const next = n->next.load().ptr();
+      delete n;
+      n = next;
+    }
+  }
+
+  /**
+   * Make sure the next n pushes won't allocate
+   */
+  void reserve(std::size_t const n) {
+    for(std::size_t i = 0; i < n; ++i) free_node(new node);
+  }
+
+  /**
+   * Add value to the back of the queue
+   */
+  void push(T const value) {
+    node* n = allocate_node();
+    n->value.store(value, std::memory_order_relaxed);
+    auto const next = n->next.load(std::memory_order_relaxed);
+    n->next.store(counted(nullptr, next), std::memory_order_relaxed);
+
+    link tail;
+    while(true) {
+      tail            = tail_.load(std::memory_order_acquire);
+      auto const last = tail.ptr()->next.load(std::memory_order_acquire);
+      if(tail.word() != tail_.load(std::memory_order_acquire).word()) continue;
+      if(last.ptr() == nullptr) {
+        auto expected = last;
+        if(tail.ptr()->next.compare_exchange_weak(expected,
+                                                  counted(n, last),
+                                                  std::memory_order_release,
+                                                  std::memory_order_relaxed))
+          break;
+      } else {
+        // tail is lagging behind: help move it along
+        tail_.compare_exchange_weak(tail,
+                                    counted(last.ptr(), tail),
+                                    std::memory_order_release,
+                                    std::memory_order_relaxed);
+      }
+    }
+    tail_.compare_exchange_strong(tail,
+                                  counted(n, tail),
+                                  std::memory_order_release,
+                                  std::memory_order_relaxed);
+  }
+
+  /**
+   * Remove the value at the front of the queue and return it, or nullopt if
+   * the queue is empty
+   */
+  std::optional<T> pop() {
+    while(true) {
+      auto const head  = head_.load(std::memory_order_acquire);
+      auto const tail  = tail_.load(std::memory_order_acquire);
+      auto const first = head.ptr()->next.load(std::memory_order_acquire);
+      if(head.word() != head_.load(std::memory_order_acquire).word()) continue;
+      if(head.ptr() == tail.ptr()) {
+        if(first.ptr() == nullptr) return std::nullopt;
+        // tail is lagging behind: help move it along
+        auto expected = tail;
+        tail_.compare_exchange_weak(expected,
+                                    counted(first.ptr(), tail),
+                                    std::memory_order_release,
+                                    std::memory_order_relaxed);
+      } else {
+        // read before the CAS: afterwards another thread may dequeue (and
+        // reuse) first
+        T const value    = first.ptr()->value.load(std::memory_order_relaxed);
+        auto    expected = head;
+        if(head_.compare_exchange_weak(expected,
+                                       counted(first.ptr(), head),
+                                       std::memory_order_acq_rel,
+                                       std::memory_order_relaxed)) {
+          free_node(head.ptr()); // the old dummy; first is the new one
+          return value;
+        }
+      }
+    }
+  }
+
+  /**
+   * Whether the queue was empty at some point during the call
+   */
+  bool empty() const noexcept {
+    auto const head = head_.load(std::memory_order_acquire);
+    return head.ptr()->next.load(std::memory_order_acquire).ptr() == nullptr;
+  }
+
+ private:
+  static constexpr std::uint32_t count_mask =
+      bits::low_mask<std::uint32_t>(count_bits);
+  // point to n, counting one more modification than old
+  static link counted(node* const n, link const old) noexcept {
+    return link{n, (old.tag() + 1) & count_mask};
+  }
+
+  // The free list is a Treiber stack threaded through the nodes' next links
+  node* allocate_node() {
+    auto old = free_.load(std::memory_order_acquire);
+    while(old.ptr() != nullptr) {
+      auto const next = old.ptr()->next.load(std::memory_order_relaxed);
+      if(free_.compare_exchange_weak(old,
+                                     counted(next.ptr(), old),
+                                     std::memory_order_acquire))
+        return old.ptr();
+    }
+    return new node;
+  }
+  void free_node(node* const n) noexcept {
+    auto old  = free_.load(std::memory_order_relaxed);
+    auto next = n->next.load(std::memory_order_relaxed);
+    do {
+      n->next.store(counted(old.ptr(), next), std::memory_order_relaxed);
+    } while(!free_.compare_exchange_weak(old,
+                                         counted(n, old),
+                                         std::memory_order_release,
+                                         std::memory_order_relaxed));
+  }
+
+  atomic_link head_;
+  atomic_link tail_;
+  atomic_link free_;
+};
+} // namespace bitpack
+
+#endif // BITPACK_LOCKFREE_QUEUE_INCLUDE_GUARD
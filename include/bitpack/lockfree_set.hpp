@@ -0,0 +1,185 @@
+#ifndef BITPACK_LOCKFREE_SET_INCLUDE_GUARD
+#define BITPACK_LOCKFREE_SET_INCLUDE_GUARD
+
+#include "macros.hpp"
+#include "atomic_tagged_ptr.hpp"
+#include "reclaim.hpp"
+
+#include <atomic>
+#include <cstddef>
+#include <functional>
+#include <optional>
+#include <utility>
+
+namespace bitpack {
+/**
+ * A lock-free sorted set: a linked list, ordered by Compare, that any number
+ * of threads can insert into, erase from and search at once (Harris, "A
+ * Pragmatic Implementation of Non-Blocking Linked-Lists", 2001, with
+ * Michael's changes for safe memory reclamation, "High Performance Dynamic
+ * Lock-Free Hash Tables and List-Based Sets", 2002).
+ *
+ * Each node's next link is a tagged_ptr<node*, bool, 1>. The tag is the
+ * "marked" bit: erase first marks the erased node's next link (logical
+ * deletion, after which that link never changes), then swings its
+ * predecessor past it. Searches unlink any marked nodes they walk past.
+ *
+ * Unlinked nodes are handed to the Reclaimer (see reclaim.hpp), which frees
+ * them once no thread can still be reading them.
+ *
+ * Key = the element type
+ * Compare = a strict weak order on Keys
+ * R = when to free erased nodes
+ */
+template<class Key,
+         class Compare = std::less<Key>,
+         Reclaimer R   = reclaim_on_destruction>
+class lockfree_set {
+  struct node;
+  // node isn't complete yet, so spell out the tag bits
+  using atomic_link = atomic_tagged_ptr<node*, bool, 1>;
+  using link        = typename atomic_link::value_type;
+  struct node {
+    Key         key;
+    atomic_link next{};
+  };
+
+ public:
+  using key_type       = Key;
+  using value_type     = Key;
+  using key_compare    = Compare;
+  using reclaimer_type = R;
+  static constexpr bool is_always_lock_free = atomic_link::is_always_lock_free;
+
+  lockfree_set() = default;
+  explicit lockfree_set(R reclaimer, Compare compare = Compare{})
+      : reclaimer_{std::move(reclaimer)}, compare_{std::move(compare)} {}
+  lockfree_set(lockfree_set const&) = delete;
+  lockfree_set& operator=(lockfree_set const&) = delete;
+  ~lockfree_set() {
+    for(node* n = head_.load().ptr(); n != nullptr;)
+      delete std::exchange(n, n->next.load().ptr());
+  }
+
+  /**
+   * Add key. Returns false (and does nothing) if it was already there.
+   */
+  bool insert(Key const& key) {
+    auto  guard = reclaimer_.pin();
+    node* n     = nullptr;
+    while(true) {
+      auto const [found, prev, cur] = find(guard, key);
+      if(found) {
+        delete n;
+        return false;
+      }
+      if(n == nullptr) n = new node{key};
+      n->next.store(unmarked(cur), std::memory_order_relaxed);
+      auto expected = unmarked(cur);
+      if(prev->compare_exchange_strong(expected,
+                                       unmarked(n),
+                                       std::memory_order_release,
+                                       std::memory_order_relaxed))
+        return true;
+    }
+  }
+
+  /**
+   * Remove key. Returns false if it wasn't there.
+   */
+  bool erase(Key const& key) {
+    auto guard = reclaimer_.pin();
+    while(true) {
+      auto const [found, prev, cur] = find(guard, key);
+      if(!found) return false;
+      auto next = cur->next.load(std::memory_order_acquire);
+      if(next.tag()) continue; // someone else is erasing it
+      // logically delete cur: nobody can link anything after it now
+      if(!cur->next.compare_exchange_strong(next,
+                                            link{next.ptr(), true},
+                                            std::memory_order_acq_rel,
+                                            std::memory_order_relaxed))
+        continue;
+      // then try to unlink it. If that fails, the next find unlinks it.
+      auto expected = unmarked(cur);
+      if(prev->compare_exchange_strong(expected,
+                                       unmarked(next.ptr()),
+                                       std::memory_order_acq_rel,
+                                       std::memory_order_relaxed))
+        reclaimer_.retire(cur);
+      else
+        find(guard, key);
+      return true;
+    }
+  }
+
+  bool contains(Key const& key) {
+    auto guard = reclaimer_.pin();
+    return find(guard, key).found;
+  }
+
+  /**
+   * Whether the set was empty at some point during the call. Marked (erased
+   * but still linked) nodes count as elements here.
+   */
+  bool empty() const noexcept {
+    return head_.load(std::memory_order_acquire).ptr() == nullptr;
+  }
+
+ private:
+  static link unmarked(node* const n) noexcept { return link{n, false}; }
+
+  struct position {
+    bool         found; // whether cur's key is equivalent to the key
+    atomic_link* prev;  // an unmarked link to cur
+    node*        cur;   // the first node whose key isn't less than the key
+  };
+
+  // Walk to the first node whose key isn't less than `key`, unlinking marked
+  // nodes on the way. On return, cur and the node holding prev are protected
+  // by the guard.
+  position find(auto& guard, Key const& key) {
+    while(true)
+      if(auto const pos = try_find(guard, key)) return *pos;
+  }
+  // nullopt = another thread changed the list under us; start over
+  std::optional<position> try_find(auto& guard, Key const& key) {
+    // rotated instead of copied as we walk, so protected nodes stay protected
+    std::size_t  prev_slot = 0, cur_slot = 1, next_slot = 2;
+    atomic_link* prev      = &head_;
+    node*        cur       = guard.protect(cur_slot, *prev).ptr();
+    while(true) {
+      if(cur == nullptr) return position{false, prev, nullptr};
+      auto const next = guard.protect(next_slot, cur->next);
+      // is cur still linked from an unmarked prev? otherwise next may be stale
+      if(prev->load(std::memory_order_acquire).word() != unmarked(cur).word())
+        return std::nullopt;
+
+      if(!next.tag()) {
+        if(!compare_(cur->key, key))
+          return position{!compare_(key, cur->key), prev, cur};
+        prev      = &cur->next;
+        prev_slot = std::exchange(cur_slot,
+                                  std::exchange(next_slot, prev_slot));
+      } else {
+        // cur is marked: unlink it
+        auto expected = unmarked(cur);
+        if(!prev->compare_exchange_strong(expected,
+                                          unmarked(next.ptr()),
+                                          std::memory_order_acq_rel,
+                                          std::memory_order_relaxed))
+          return std::nullopt;
+        reclaimer_.retire(cur);
+        std::swap(cur_slot, next_slot);
+      }
+      cur = next.ptr();
+    }
+  }
+
+  atomic_link                   head_;
+  R                             reclaimer_;
+  [[no_unique_address]] Compare compare_;
+};
+} // namespace bitpack
+
+#endif // BITPACK_LOCKFREE_SET_INCLUDE_GUARD
@@ -0,0 +1,138 @@
+#ifndef BITPACK_LOCKFREE_STACK_INCLUDE_GUARD
+#define BITPACK_LOCKFREE_STACK_INCLUDE_GUARD
+
+#include "macros.hpp"
+#include "bits.hpp"
+#include "atomic_tagged_ptr.hpp"
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <optional>
+#include <utility>
+
+namespace bitpack {
+/**
+ * A lock-free (Treiber) stack. Any number of threads can push and pop at
+ * once.
+ *
+ * The head is an atomic_high_low_tagged_ptr whose tag is a version counter,
+ * bumped on every change, so a single word CAS notices when the head was
+ * popped and pushed back in between (the ABA problem). No double-width CAS
+ * needed.
+ *
+ * Popped nodes aren't freed. They go on an internal free list (another tagged
+ * stack) and get reused by later pushes, so a thread that's still looking at a
+ * node another thread popped reads valid memory. The nodes are freed when the
+ * stack is destroyed.
+ */
+template<class T> class lockfree_stack {
+  struct node {
+    std::atomic<node*> next{nullptr};
+    union {
+      T value;
+    };
+    node() noexcept {}
+    ~node() {}
+  };
+  using atomic_head = atomic_high_low_tagged_ptr<node*, std::uint32_t>;
+  using head        = typename atomic_head::value_type;
+
+ public:
+  using value_type = T;
+  /**
+   * How many bits the version counter has. It wraps around, so ABA is only
+   * missed if the head changes exactly a multiple of 2^version_bits times
+   * between one thread's load and CAS.
+   */
+  static constexpr std::size_t version_bits = head::tag_bits;
+  static constexpr bool is_always_lock_free = atomic_head::is_always_lock_free;
+
+  constexpr lockfree_stack() noexcept = default;
+  lockfree_stack(lockfree_stack const&) = delete;
+  lockfree_stack& operator=(lockfree_stack const&) = delete;
+  ~lockfree_stack() {
+    while(node* const n = pop_node(top_)) {
+      std::destroy_at(&n->value);
+      delete n;
+    }
+    while(node* const n = pop_node(free_)) delete n;
+  }
+
+  /**
+   * Make sure the next n pushes won't allocate
+   */
+  void reserve(std::size_t const n) {
+    for(std::size_t i = 0; i < n; ++i) push_node(free_, new node);
+  }
+
+  void push(T const& value) { emplace(value); }
+  void push(T&& value) { emplace(std::move(value)); }
+  template<class... Args> void emplace(Args&&... args) {
+    node* n = pop_node(free_);
+    if(n == nullptr) n = new node;
+    try {
+      std::construct_at(&n->value, std::forward<Args>(args)...);
+    } catch(...) {
+      push_node(free_, n);
+      throw;
+    }
+    push_node(top_, n);
+  }
+
+  /**
+   * Remove the top element and return it, or nullopt if the stack is empty
+   */
+  std::optional<T> pop() {
+    node* const n = pop_node(top_);
+    if(n == nullptr) return std::nullopt;
+    std::optional<T> out{std::move(n->value)};
+    std::destroy_at(&n->value);
+    push_node(free_, n);
+    return out;
+  }
+
+  /**
+   * Whether the stack was empty at some point during the call
+   */
+  bool empty() const noexcept {
+    return top_.load(std::memory_order_acquire).ptr() == nullptr;
+  }
+
+ private:
+  static constexpr std::uint32_t version_mask =
+      bits::low_mask<std::uint32_t>(version_bits);
+  static head next_version(node* const n, head const old) noexcept {
+    return head{n, (old.tag() + 1) & version_mask};
+  }
+
+  static void push_node(atomic_head& list, node* const n) noexcept {
+    auto old = list.load(std::memory_order_relaxed);
+    do {
+      n->next.store(old.ptr(), std::memory_order_relaxed);
+    } while(!list.compare_exchange_weak(old,
+                                        next_version(n, old),
+                                        std::memory_order_release,
+                                        std::memory_order_relaxed));
+  }
+  static node* pop_node(atomic_head& list) noexcept {
+    auto old = list.load(std::memory_order_acquire);
+    while(old.ptr() != nullptr) {
+      // old.ptr() may have been popped (and even reused) by now. It's still a
+      // live node though, and then the version has changed so the CAS fails.
+      auto* const next = old.ptr()->next.load(std::memory_order_relaxed);
+      if(list.compare_exchange_weak(old,
+                                    next_version(next, old),
+                                    std::memory_order_acquire))
+        return old.ptr();
+    }
+    return nullptr;
+  }
+
+  atomic_head top_;
+  atomic_head free_;
+};
+} // namespace bitpack
+
+#endif // BITPACK_LOCKFREE_STACK_INCLUDE_GUARD
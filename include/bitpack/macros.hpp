@@ -60,6 +60,23 @@ inline bool constexpr is_assert_off = !BITPACK_ENABLE_ASSERT;
 #  define BITPACK_DIAGNOSTIC_POP
 #endif
 
+// Runtime dispatch between instruction sets (see bulk.hpp). We compile the
+// same loop for several targets with __attribute__((target)) and pick one with
+// __builtin_cpu_supports, so this needs gcc or clang on x86-64.
+// Define BITPACK_SIMD_DISPATCH to 0 to always use the baseline build.
+#if !defined(BITPACK_SIMD_DISPATCH)
+#  if(defined(__GNUC__) || defined(__clang__)) && defined(__x86_64__)
+#    define BITPACK_SIMD_DISPATCH 1
+#  else
+#    define BITPACK_SIMD_DISPATCH 0
+#  endif
+#endif
+#if BITPACK_SIMD_DISPATCH
+#  define BITPACK_TARGET(isa) __attribute__((target(isa)))
+#else
+#  define BITPACK_TARGET(isa)
+#endif
+
 // here we have preprocessor looping constructs. These seem semi-standard.
 // Boost::preprocessor discusses + implements more generic facilities like these.
 //
@@ -0,0 +1,180 @@
+#ifndef BITPACK_NAN_BOX_INCLUDE_GUARD
+#define BITPACK_NAN_BOX_INCLUDE_GUARD
+
+#include "macros.hpp"
+#include "bits.hpp"
+#include "variant_ptr.hpp"
+
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <type_traits>
+
+namespace bitpack {
+/**
+ * A dynamically typed value in 64 bits: a double, or (hidden in the payload
+ * of a NaN) null, a bool, a 32 bit int or one of the pointer types Ptrs. The
+ * usual value type of a scripting language's stack, at half the size of the
+ * equivalent std::variant.
+ *
+ * Doubles are stored as they are, except that every NaN is stored as the one
+ * canonical quiet NaN. Everything else goes in the words that start with 13 1
+ * bits (negative quiet NaNs, which are never stored as doubles): 3 tag bits,
+ * then a 48 bit payload. So pointers must fit in 48 bits, which user space
+ * pointers do on x86-64 and AArch64 (but not with 5 level paging, pointer
+ * authentication, ...).
+ *
+ * It has variant_ptr's interface. The alternatives are, by index: double,
+ * std::nullptr_t, bool, std::int32_t, Ptrs...
+ *
+ * Ptrs = the pointer types it can hold (at most 5)
+ */
+template<class... Ptrs> class nan_box {
+  static_assert(std::numeric_limits<double>::is_iec559,
+                "NaN boxing needs IEEE 754 doubles");
+  static_assert(sizeof(double) == sizeof(std::uint64_t));
+  static_assert((... && std::is_pointer_v<Ptrs>),
+                "A nan_box can only hold raw pointers");
+  static_assert(sizeof...(Ptrs) <= 5, "At most 5 pointer types");
+  using types =
+      impl::typelist<double, std::nullptr_t, bool, std::int32_t, Ptrs...>;
+  using self_type = nan_box; // for BITPACK_UNROLL_VISIT
+
+  // the words that aren't doubles: sign, exponent and quiet bit all set
+  static constexpr std::uint64_t boxed = std::uint64_t{0xFFF8} << 48;
+  static constexpr std::uint64_t payload_mask =
+      bits::low_mask<std::uint64_t>(48);
+  static constexpr std::uint64_t canonical_nan = std::uint64_t{0x7FF8} << 48;
+
+ public:
+  static constexpr auto size = types::size;
+  using Tag                  = int;
+
+  static constexpr Tag index(nan_box const self) noexcept {
+    if(self.word_ < boxed) return 0;
+    return static_cast<Tag>((self.word_ >> 48) & 7) + 1;
+  }
+  constexpr Tag index() const noexcept { return index(*this); }
+
+  /**
+   * The packed bits
+   */
+  static constexpr std::uint64_t word(nan_box const self) noexcept {
+    return self.word_;
+  }
+  constexpr std::uint64_t word() const noexcept { return word(*this); }
+  /**
+   * Reinterpret bits (as returned by word()) as a nan_box
+   */
+  static constexpr nan_box from_word(std::uint64_t const word) noexcept {
+    nan_box self;
+    self.word_ = word;
+    return self;
+  }
+
+  // (a value-initialized nan_box is the double 0.0)
+  constexpr nan_box() = default;
+  constexpr nan_box(double const d) noexcept
+      : word_{d != d ? canonical_nan : bits::bit_cast<std::uint64_t>(d)} {}
+  constexpr nan_box(std::nullptr_t) noexcept : word_{box<std::nullptr_t>(0)} {}
+  // a template, so pointers and ints that aren't alternatives don't convert
+  template<std::same_as<bool> B>
+  constexpr nan_box(B const b) noexcept : word_{box<bool>(b)} {}
+  constexpr nan_box(std::int32_t const i) noexcept
+      : word_{box<std::int32_t>(static_cast<std::uint32_t>(i))} {}
+  template<class T>
+  requires(sizeof...(Ptrs) > 0 && (... || std::is_same_v<T, Ptrs>)) //
+      nan_box(T const ptr) noexcept(impl::is_assert_off)
+      : word_{box<T>(bits::bit_cast<std::uintptr_t>(ptr))} {
+    BITPACK_ASSERT((bits::bit_cast<std::uintptr_t>(ptr) & ~payload_mask) == 0);
+  }
+
+  template<Tag N>
+  static constexpr auto get(nan_box const self) noexcept(impl::is_assert_off)
+      -> typename types::template nth<N> {
+    static_assert(0 <= N && N < size, "The variant index is out of bounds");
+    return get<typename types::template nth<N>>(self);
+  }
+  template<class T>
+  static constexpr T get(nan_box const self) noexcept(impl::is_assert_off) {
+    static_assert(types::template has<T>, "That type is not in this variant");
+    BITPACK_ASSERT(holds_alternative<T>(self));
+    auto const payload = self.word_ & payload_mask;
+    if constexpr(std::is_same_v<T, double>)
+      return bits::bit_cast<double>(self.word_);
+    else if constexpr(std::is_same_v<T, std::nullptr_t>)
+      return nullptr;
+    else if constexpr(std::is_same_v<T, bool>)
+      return payload != 0;
+    else if constexpr(std::is_same_v<T, std::int32_t>)
+      return static_cast<std::int32_t>(static_cast<std::uint32_t>(payload));
+    else
+      return bits::bit_cast<T>(static_cast<std::uintptr_t>(payload));
+  }
+
+  template<class T>
+  static constexpr bool holds_alternative(nan_box const self) noexcept {
+    return index(self) == types::template find<T>;
+  }
+
+  /**
+   * Same bits (so a NaN is identical to itself, and 0.0 isn't to -0.0)
+   */
+  friend constexpr bool identical(nan_box const a, nan_box const b) noexcept {
+    return a.word_ == b.word_;
+  }
+
+ private:
+  template<class T>
+  static constexpr std::uint64_t box(std::uint64_t const payload) noexcept {
+    return boxed | (std::uint64_t{types::template find<T> - 1} << 48)
+           | payload;
+  }
+
+  template<class Func>
+  static constexpr bool is_visit_noexcept =
+      impl::is_visit_noexcept_by_seq<nan_box,
+                                     Func,
+                                     std::make_index_sequence<size>>::value;
+
+  template<class Func>
+  using visit_common_type = typename impl::visit_common_type_by_seq<
+      nan_box,
+      Func,
+      std::make_index_sequence<size>>::type;
+
+  std::uint64_t word_;
+
+ public:
+  // the same visit as variant_ptr: a switch up to BITPACK_UNROLL_VISIT_LIMIT
+  // alternatives, a jump table after that
+  BITPACK_WRETURN_OFF
+    BITPACK_REPEAT_OUTER(BITPACK_UNROLL_VISIT, BITPACK_UNROLL_VISIT_LIMIT)
+  BITPACK_DIAGNOSTIC_POP
+
+  template<class R, class Func>
+  requires(size >= BITPACK_UNROLL_VISIT_LIMIT) //
+      static constexpr R
+      visit(Func          visitor,
+            nan_box const self) noexcept(is_visit_noexcept<Func>) {
+    BITPACK_ASSERT(0 <= index(self) && index(self) < bits::narrow<int>(size));
+    return impl::visit_table<R,
+                             Func,
+                             nan_box,
+                             std::make_index_sequence<size>>::visit(visitor,
+                                                                    self);
+  }
+
+  template<class Func>
+  static constexpr auto visit(Func visitor, nan_box const self)
+      BITPACK_EXPR_BODY(visit<visit_common_type<Func>, Func>(visitor, self))
+};
+
+namespace impl {
+// so several can be visited at once, and mixed with variant_ptrs
+template<class... Ptrs>
+inline constexpr bool is_variant_ptr<nan_box<Ptrs...>> = true;
+} // namespace impl
+} // namespace bitpack
+
+#endif // BITPACK_NAN_BOX_INCLUDE_GUARD
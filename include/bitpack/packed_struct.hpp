@@ -0,0 +1,199 @@
+#ifndef BITPACK_PACKED_STRUCT_INCLUDE_GUARD
+#define BITPACK_PACKED_STRUCT_INCLUDE_GUARD
+
+#include "macros.hpp"
+#include "bits.hpp"
+#include "workaround.hpp"
+
+#include <compare>
+#include <concepts>
+#include <cstddef>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+
+namespace bitpack {
+/**
+ * One field of a packed_struct: a T stored in width bits, encoded with
+ * Encoding (see bits::raw_encoding and bits::ordered_encoding). Narrow signed
+ * fields need bits::ordered_encoding to get their sign back.
+ */
+template<class T,
+         std::size_t width_ = bits::bit_sizeof<T>,
+         class Encoding     = bits::raw_encoding>
+struct field {
+  using type                         = T;
+  using encoding                     = Encoding;
+  static constexpr std::size_t width = width_;
+  static_assert(0 < width && width <= bits::bit_sizeof<T>,
+                "A field takes between 1 bit and its type's size");
+};
+
+/**
+ * UInt_pair for any number of fields: a record packed into one UInt, with the
+ * layout fixed at compile time. The first field goes in the highest bits and
+ * each one after it right below the last (any bits left over are at the top,
+ * and 0), so when every field's encoding preserves order, the words order the
+ * same way as the records (lexicographically), and comparing is one integer
+ * comparison.
+ *
+ * It works with structured bindings (auto [a, b, c] = s;), std::tuple_size
+ * and std::tuple_element. Fields are read-only, like UInt_pair's.
+ *
+ * UInt = the unsigned int type to pack the fields into (bits::uint128_t or
+ * bits::wide_uint<N> for more than 64 bits; fields can straddle its words)
+ * Fields = field<T, width, Encoding>s, in order
+ */
+template<bits::unsigned_word UInt, class... Fields> class packed_struct {
+  static_assert(sizeof...(Fields) > 0, "A packed_struct needs a field");
+  static_assert((0 + ... + Fields::width) <= bits::bit_sizeof<UInt>,
+                "The fields don't fit in the UInt");
+
+  static constexpr std::size_t widths[] = {Fields::width...};
+  // how far field i is from the low end: the widths of the fields after it
+  static constexpr std::size_t shift_of(std::size_t const i) noexcept {
+    std::size_t shift = 0;
+    for(auto j = i + 1; j < sizeof...(Fields); ++j) shift += widths[j];
+    return shift;
+  }
+
+  template<std::size_t i>
+  using nth_field = std::tuple_element_t<i, std::tuple<Fields...>>;
+
+  // the index of the only field of type T
+  template<class T>
+  static constexpr std::size_t index_of = [] {
+    constexpr bool is_T[] = {std::is_same_v<T, typename Fields::type>...};
+    static_assert((0 + ... + std::is_same_v<T, typename Fields::type>) == 1,
+                  "There has to be exactly one field of that type");
+    std::size_t i = 0;
+    while(!is_T[i]) ++i;
+    return i;
+  }();
+
+ public:
+  static constexpr std::size_t size      = sizeof...(Fields);
+  static constexpr std::size_t used_bits = (0 + ... + Fields::width);
+  using word_type                        = UInt;
+  template<std::size_t i> using nth_t    = typename nth_field<i>::type;
+
+  /**
+   * Does the packed word order the same way as the record? Then comparing
+   * words is the same as comparing fields lexicographically.
+   */
+  static constexpr bool is_word_ordered =
+      (... && Fields::encoding::template preserves_order<
+                  typename Fields::type>);
+  static constexpr bool is_word_equality =
+      is_word_ordered
+      || (... && Fields::encoding::template preserves_equality<
+                     typename Fields::type>);
+
+  constexpr packed_struct() = default;
+  explicit constexpr packed_struct(
+      typename Fields::type const... values) noexcept(impl::is_assert_off)
+      : word_{pack(std::index_sequence_for<Fields...>{}, values...)} {
+    // postcondition: every value fit in its field
+    BITPACK_ASSERT(holds(std::index_sequence_for<Fields...>{}, values...));
+  }
+
+  /**
+   * The packed bits
+   */
+  constexpr static UInt word(packed_struct const self) noexcept {
+    return self.word_;
+  }
+  constexpr UInt word() const noexcept { return word(*this); }
+  /**
+   * Reinterpret packed bits (as returned by word()) as a packed_struct
+   */
+  constexpr static packed_struct from_word(UInt const word) noexcept {
+    packed_struct self;
+    self.word_ = word;
+    return self;
+  }
+
+  /**
+   * The i-th field. Read-only.
+   */
+  template<std::size_t i>
+  requires(i < size) //
+      static constexpr nth_t<i> get(packed_struct const self) noexcept {
+    using F               = nth_field<i>;
+    constexpr auto shift  = shift_of(i);
+    auto const     stored = static_cast<UInt>(
+        (self.word_ >> shift) & bits::low_mask<UInt>(F::width));
+    return F::encoding::template decode<typename F::type, F::width>(stored);
+  }
+  /**
+   * The field of type T (there has to be exactly one)
+   */
+  template<class T> static constexpr T get(packed_struct const self) noexcept {
+    return get<index_of<T>>(self);
+  }
+  // for structured bindings
+  template<std::size_t i>
+  requires(i < size) //
+      constexpr nth_t<i> get() const noexcept {
+    return get<i>(*this);
+  }
+
+  friend constexpr std::tuple<typename Fields::type...>
+      to_tuple(packed_struct const self) noexcept {
+    return unpack(self, std::index_sequence_for<Fields...>{});
+  }
+
+  // compare the words when that means the same thing, otherwise field by field
+  friend constexpr bool operator==(packed_struct const a,
+                                   packed_struct const b) noexcept {
+    if constexpr(is_word_equality)
+      return a.word_ == b.word_;
+    else
+      return to_tuple(a) == to_tuple(b);
+  }
+  friend constexpr auto operator<=>(packed_struct const a,
+                                    packed_struct const b) noexcept {
+    if constexpr(is_word_ordered)
+      return a.word_ <=> b.word_;
+    else
+      return to_tuple(a) <=> to_tuple(b);
+  }
+
+ private:
+  template<std::size_t... i>
+  static constexpr UInt pack(std::index_sequence<i...>,
+                             typename Fields::type const... values) noexcept {
+    return static_cast<UInt>(
+        (UInt{} | ...
+         | static_cast<UInt>(
+             nth_field<i>::encoding::template encode<UInt, widths[i]>(values)
+             << shift_of(i))));
+  }
+  // (with NaNs equal to themselves, since ordered fields keep them)
+  template<std::size_t... i>
+  constexpr bool holds(std::index_sequence<i...>,
+                       typename Fields::type const... values) const noexcept {
+    return (... && bits::impl::round_trips(get<i>(*this), values));
+  }
+  template<std::size_t... i>
+  static constexpr std::tuple<typename Fields::type...>
+      unpack(packed_struct const self, std::index_sequence<i...>) noexcept {
+    return {get<i>(self)...};
+  }
+
+  UInt word_;
+};
+} // namespace bitpack
+
+template<bitpack::bits::unsigned_word UInt, class... Fields>
+struct std::tuple_size<bitpack::packed_struct<UInt, Fields...>>
+    : std::integral_constant<std::size_t, sizeof...(Fields)> {};
+template<std::size_t                  i,
+         bitpack::bits::unsigned_word UInt,
+         class... Fields>
+struct std::tuple_element<i, bitpack::packed_struct<UInt, Fields...>> {
+  using type =
+      typename bitpack::packed_struct<UInt, Fields...>::template nth_t<i>;
+};
+
+#endif // BITPACK_PACKED_STRUCT_INCLUDE_GUARD
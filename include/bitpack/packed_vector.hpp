@@ -0,0 +1,300 @@
+#ifndef BITPACK_PACKED_VECTOR_INCLUDE_GUARD
+#define BITPACK_PACKED_VECTOR_INCLUDE_GUARD
+
+#include "macros.hpp"
+#include "bits.hpp"
+
+#include <compare>
+#include <cstddef>
+#include <cstdint>
+#include <initializer_list>
+#include <iterator>
+#include <span>
+#include <vector>
+
+namespace bitpack {
+/**
+ * A vector that stores each element in exactly `Bits` bits. Elements are laid
+ * end to end in a buffer of 64 bit words (so they can straddle two words). A
+ * 13 bit id takes 13 bits instead of 16 or 32.
+ *
+ * Because elements don't live at their own address, operator[] and iterators
+ * hand out proxy references (like std::vector<bool>).
+ *
+ * T = the element type
+ * Bits = how many bits each element takes (at most 64)
+ * Encoding = how values are stored in their bits (see bits::raw_encoding and
+ * bits::ordered_encoding)
+ */
+template<class T, std::size_t Bits, class Encoding = bits::raw_encoding>
+class packed_vector {
+ public:
+  using word_type = std::uint64_t;
+  static constexpr std::size_t bits_per_element = Bits;
+  static_assert(0 < Bits && Bits <= bits::bit_sizeof<word_type>,
+                "An element must fit in one word");
+
+ private:
+  static constexpr std::size_t word_bits = bits::bit_sizeof<word_type>;
+  static constexpr word_type   mask      = bits::low_mask<word_type>(Bits);
+
+  static constexpr std::size_t words_for(std::size_t const n) noexcept {
+    return (n * Bits + word_bits - 1) / word_bits;
+  }
+
+  static constexpr word_type encode(T const x) noexcept(impl::is_assert_off) {
+    auto const stored = Encoding::template encode<word_type, Bits>(x);
+    // postcondition: x fits in Bits bits (NaNs come back as NaNs)
+    BITPACK_ASSERT(bits::impl::round_trips(decode(stored), x));
+    return stored;
+  }
+  static constexpr T decode(word_type const bits) noexcept {
+    return Encoding::template decode<T, Bits>(bits);
+  }
+
+  // read/write the Bits bits starting at bit `bit` of words
+  static constexpr word_type read(word_type const* const words,
+                                  std::size_t const      bit) noexcept {
+    auto const w      = bit / word_bits;
+    auto const offset = bit % word_bits;
+    auto       x      = words[w] >> offset;
+    if(offset + Bits > word_bits) x |= words[w + 1] << (word_bits - offset);
+    return x & mask;
+  }
+  static constexpr void write(word_type* const  words,
+                              std::size_t const bit,
+                              word_type const   x) noexcept {
+    auto const w      = bit / word_bits;
+    auto const offset = bit % word_bits;
+    words[w]          = (words[w] & ~(mask << offset)) | (x << offset);
+    if(offset + Bits > word_bits) {
+      auto const spilled = word_bits - offset; // bits already written
+      words[w + 1] = (words[w + 1] & ~(mask >> spilled)) | (x >> spilled);
+    }
+  }
+
+ public:
+  using value_type      = T;
+  using size_type       = std::size_t;
+  using difference_type = std::ptrdiff_t;
+
+  /**
+   * A proxy for one element. Converts to T and can be assigned a T.
+   */
+  class reference {
+   public:
+    constexpr operator T() const noexcept {
+      return decode(read(vec_->words_.data(), index_ * Bits));
+    }
+    constexpr reference const& operator=(T const x) const
+        noexcept(impl::is_assert_off) {
+      write(vec_->words_.data(), index_ * Bits, encode(x));
+      return *this;
+    }
+    constexpr reference const& operator=(reference const& other) const
+        noexcept(impl::is_assert_off) {
+      return *this = static_cast<T>(other);
+    }
+    friend constexpr void swap(reference const a, reference const b) noexcept(
+        impl::is_assert_off) {
+      T const tmp = a;
+      a           = static_cast<T>(b);
+      b           = tmp;
+    }
+
+   private:
+    friend packed_vector;
+    constexpr reference(packed_vector* const vec,
+                        size_type const      index) noexcept
+        : vec_{vec}, index_{index} {}
+    packed_vector* vec_;
+    size_type      index_;
+  };
+
+ private:
+  template<bool is_const> class iterator_ {
+    using vector_ptr =
+        std::conditional_t<is_const, packed_vector const*, packed_vector*>;
+
+   public:
+    using iterator_category = std::random_access_iterator_tag;
+    using iterator_concept  = std::random_access_iterator_tag;
+    using value_type        = T;
+    using difference_type   = std::ptrdiff_t;
+    using reference =
+        std::conditional_t<is_const, T, typename packed_vector::reference>;
+    using pointer = void;
+
+    constexpr iterator_() = default;
+    constexpr iterator_(vector_ptr const vec, size_type const index) noexcept
+        : vec_{vec}, index_{index} {}
+    // iterator -> const_iterator
+    template<bool other_is_const>
+    requires(is_const && !other_is_const) //
+        constexpr iterator_(iterator_<other_is_const> const other) noexcept
+        : vec_{other.vec_}, index_{other.index_} {}
+
+    constexpr reference operator*() const noexcept(impl::is_assert_off) {
+      return (*vec_)[index_];
+    }
+    constexpr reference operator[](difference_type const n) const
+        noexcept(impl::is_assert_off) {
+      return *(*this + n);
+    }
+
+    constexpr iterator_& operator++() noexcept { return *this += 1; }
+    constexpr iterator_& operator--() noexcept { return *this -= 1; }
+    constexpr iterator_  operator++(int) noexcept {
+      auto const old = *this;
+      ++*this;
+      return old;
+    }
+    constexpr iterator_ operator--(int) noexcept {
+      auto const old = *this;
+      --*this;
+      return old;
+    }
+    constexpr iterator_& operator+=(difference_type const n) noexcept {
+      index_ += n;
+      return *this;
+    }
+    constexpr iterator_& operator-=(difference_type const n) noexcept {
+      index_ -= n;
+      return *this;
+    }
+    friend constexpr iterator_ operator+(iterator_       it,
+                                         difference_type n) noexcept {
+      return it += n;
+    }
+    friend constexpr iterator_ operator+(difference_type n,
+                                         iterator_       it) noexcept {
+      return it += n;
+    }
+    friend constexpr iterator_ operator-(iterator_       it,
+                                         difference_type n) noexcept {
+      return it -= n;
+    }
+    friend constexpr difference_type operator-(iterator_ const a,
+                                               iterator_ const b) noexcept {
+      return static_cast<difference_type>(a.index_)
+             - static_cast<difference_type>(b.index_);
+    }
+    friend constexpr bool operator==(iterator_ const a,
+                                     iterator_ const b) noexcept {
+      return a.index_ == b.index_;
+    }
+    friend constexpr auto operator<=>(iterator_ const a,
+                                      iterator_ const b) noexcept {
+      return a.index_ <=> b.index_;
+    }
+
+   private:
+    template<bool> friend class iterator_;
+    vector_ptr vec_   = nullptr;
+    size_type  index_ = 0;
+  };
+
+ public:
+  using iterator       = iterator_<false>;
+  using const_iterator = iterator_<true>;
+
+  constexpr packed_vector() = default;
+  explicit constexpr packed_vector(size_type const n, T const value = T{})
+      : packed_vector{} {
+    resize(n, value);
+  }
+  constexpr packed_vector(std::initializer_list<T> const xs) : packed_vector{} {
+    reserve(xs.size());
+    for(auto const x : xs) push_back(x);
+  }
+
+  constexpr size_type size() const noexcept { return size_; }
+  constexpr bool      empty() const noexcept { return size_ == 0; }
+  constexpr size_type capacity() const noexcept {
+    return words_.capacity() * word_bits / Bits;
+  }
+  constexpr void reserve(size_type const n) { words_.reserve(words_for(n)); }
+  constexpr void clear() noexcept {
+    words_.clear();
+    size_ = 0;
+  }
+  constexpr void resize(size_type const n, T const value = T{}) {
+    auto const old_size = size_;
+    words_.resize(words_for(n));
+    size_ = n;
+    for(auto i = old_size; i < n; ++i) (*this)[i] = value;
+  }
+
+  constexpr void push_back(T const x) {
+    if(words_for(size_ + 1) > words_.size()) words_.push_back(0);
+    write(words_.data(), size_ * Bits, encode(x));
+    ++size_;
+  }
+  constexpr void pop_back() noexcept(impl::is_assert_off) {
+    BITPACK_ASSERT(!empty());
+    --size_;
+    words_.resize(words_for(size_));
+  }
+
+  constexpr reference operator[](size_type const i) noexcept(
+      impl::is_assert_off) {
+    BITPACK_ASSERT(i < size_);
+    return reference{this, i};
+  }
+  constexpr T operator[](size_type const i) const
+      noexcept(impl::is_assert_off) {
+    BITPACK_ASSERT(i < size_);
+    return decode(read(words_.data(), i * Bits));
+  }
+  constexpr reference front() noexcept(impl::is_assert_off) {
+    return (*this)[0];
+  }
+  constexpr T front() const noexcept(impl::is_assert_off) { return (*this)[0]; }
+  constexpr reference back() noexcept(impl::is_assert_off) {
+    return (*this)[size_ - 1];
+  }
+  constexpr T back() const noexcept(impl::is_assert_off) {
+    return (*this)[size_ - 1];
+  }
+
+  /**
+   * Decode out.size() elements, starting at index `first`, into out. This walks
+   * the buffer once instead of locating each element separately.
+   */
+  constexpr void get_range(size_type const    first,
+                           std::span<T> const out) const
+      noexcept(impl::is_assert_off) {
+    BITPACK_ASSERT(first + out.size() <= size_);
+    auto const* w      = words_.data() + first * Bits / word_bits;
+    std::size_t offset = first * Bits % word_bits;
+    for(auto& x : out) {
+      auto bits = w[0] >> offset;
+      if(offset + Bits > word_bits) bits |= w[1] << (word_bits - offset);
+      x = decode(bits & mask);
+      offset += Bits;
+      w += offset / word_bits;
+      offset %= word_bits;
+    }
+  }
+
+  constexpr iterator       begin() noexcept { return {this, 0}; }
+  constexpr iterator       end() noexcept { return {this, size_}; }
+  constexpr const_iterator begin() const noexcept { return {this, 0}; }
+  constexpr const_iterator end() const noexcept { return {this, size_}; }
+  constexpr const_iterator cbegin() const noexcept { return begin(); }
+  constexpr const_iterator cend() const noexcept { return end(); }
+
+  /**
+   * The underlying buffer of packed words
+   */
+  constexpr std::span<word_type const> words() const noexcept {
+    return words_;
+  }
+
+ private:
+  std::vector<word_type> words_;
+  size_type              size_ = 0;
+};
+} // namespace bitpack
+
+#endif // BITPACK_PACKED_VECTOR_INCLUDE_GUARD
@@ -4,6 +4,7 @@
 #include "bits.hpp"
 #include "workaround.hpp"
 
+#include <compare>
 #include <type_traits>
 
 namespace bitpack {
@@ -11,25 +12,51 @@ namespace bitpack {
  * A pair packed into a specified UInt type.
  * X = the type on the "left"
  * Y = the type on the "right"
- * UInt = the unsigned int type to stuff the pair into
+ * UInt = the unsigned int type to stuff the pair into (bits::uint128_t or
+ * bits::wide_uint<N> for more than 64 bits)
  * low_bit_count_ = how many bits of the Y value do we store?
+ * Encoding = how values are stored in their bits (see bits::raw_encoding and
+ * bits::ordered_encoding)
+ *
+ * X is kept in the high bits and Y in the low bits, so when the encoding
+ * preserves the order of both, the packed word orders the same way as the pair
+ * (lexicographically) and comparisons are a single integer comparison.
  */
 template<class X,
          class Y,
-         std::unsigned_integral UInt,
-         size_t                 low_bit_count_ = bits::bit_sizeof<Y>>
+         bits::unsigned_word    UInt,
+         size_t                 low_bit_count_ = bits::bit_sizeof<Y>,
+         class Encoding                        = bits::raw_encoding>
 class UInt_pair {
  public:
   static constexpr auto low_bit_count  = low_bit_count_;
   static constexpr auto high_bit_count = sizeof(UInt) * 8 - low_bit_count;
+  static_assert(0 < low_bit_count && low_bit_count < bits::bit_sizeof<UInt>,
+                "Both elements need at least one bit");
+
+  using first_type  = X;
+  using second_type = Y;
+  using word_type   = UInt;
 
  private:
-  UInt y_ : low_bit_count; // little endian : low = lsb = first(lowest address)
-  UInt x_ : high_bit_count;
+  UInt word_; // y in the low bits, x in the high bits
 
   template<int i> using nth_t = std::conditional_t<i == 0, X, Y>;
 
+
  public:
+  /**
+   * Does the packed word order the same way as the pair? Then comparing words
+   * is the same as comparing pairs lexicographically.
+   */
+  static constexpr bool is_word_ordered =
+      Encoding::template preserves_order<X>
+      && Encoding::template preserves_order<Y>;
+  static constexpr bool is_word_equality =
+      is_word_ordered
+      || (Encoding::template preserves_equality<X>
+          && Encoding::template preserves_equality<Y>);
+
   constexpr UInt_pair() = default;
 
   /**
@@ -38,21 +65,64 @@ class UInt_pair {
    */
   explicit constexpr UInt_pair(X const x,
                                Y const y) noexcept(impl::is_assert_off)
-      : y_{bits::as_UInt<UInt>(y)}, x_{bits::as_UInt<UInt>(x)} {
+      : word_{static_cast<UInt>(
+          (Encoding::template encode<UInt, high_bit_count>(x) << low_bit_count)
+          | Encoding::template encode<UInt, low_bit_count>(y))} {
     // postcondition
-    BITPACK_ASSERT(this->x() == x);
-    BITPACK_ASSERT(this->y() == y);
+    BITPACK_ASSERT(bits::impl::round_trips(this->x(), x));
+    BITPACK_ASSERT(bits::impl::round_trips(this->y(), y));
   }
 
   constexpr static X x(const UInt_pair self) noexcept {
-    return bits::from_UInt<X>(self.x_);
+    return Encoding::template decode<X, high_bit_count>(
+        static_cast<UInt>(self.word_ >> low_bit_count));
   }
   constexpr static Y y(const UInt_pair self) noexcept {
-    return bits::from_UInt<Y>(self.y_);
+    return Encoding::template decode<Y, low_bit_count>(
+        static_cast<UInt>(self.word_ & bits::low_mask<UInt>(low_bit_count)));
   }
   constexpr X x() const noexcept { return x(*this); }
   constexpr Y y() const noexcept { return y(*this); }
 
+  /**
+   * A copy with x replaced. Only x's bits are touched (one mask and one or):
+   * y isn't decoded and encoded again.
+   */
+  constexpr UInt_pair with_x(X const x) const noexcept(impl::is_assert_off) {
+    auto const pair = from_word(static_cast<UInt>(
+        (word_ & bits::low_mask<UInt>(low_bit_count))
+        | (Encoding::template encode<UInt, high_bit_count>(x)
+           << low_bit_count)));
+    BITPACK_ASSERT(bits::impl::round_trips(pair.x(), x));
+    return pair;
+  }
+  /**
+   * A copy with y replaced. x isn't touched.
+   */
+  constexpr UInt_pair with_y(Y const y) const noexcept(impl::is_assert_off) {
+    auto const pair = from_word(static_cast<UInt>(
+        (word_ & ~bits::low_mask<UInt>(low_bit_count))
+        | Encoding::template encode<UInt, low_bit_count>(y)));
+    BITPACK_ASSERT(bits::impl::round_trips(pair.y(), y));
+    return pair;
+  }
+
+  /**
+   * The packed bits of the pair
+   */
+  constexpr static UInt word(UInt_pair const self) noexcept {
+    return self.word_;
+  }
+  constexpr UInt word() const noexcept { return word(*this); }
+  /**
+   * Reinterpret packed bits (as returned by word()) as a pair
+   */
+  constexpr static UInt_pair from_word(UInt const word) noexcept {
+    UInt_pair pair;
+    pair.word_ = word;
+    return pair;
+  }
+
   /**
    * Return the i-th element of pair (i= 0 or 1). Read-only.
    */
@@ -78,6 +148,19 @@ class UInt_pair {
       return y(pair);
   }
 
+  // When the encoding preserves order/equality, compare the packed words
+  // directly instead of unpacking. These beat the generic templates below.
+  friend constexpr bool operator==(UInt_pair const a,
+                                   UInt_pair const b) noexcept
+      requires is_word_equality {
+    return a.word_ == b.word_;
+  }
+  friend constexpr std::strong_ordering
+      operator<=>(UInt_pair const a, UInt_pair const b) noexcept
+      requires is_word_ordered {
+    return a.word_ <=> b.word_;
+  }
+
   // it's annoying to spell out the exact type
   friend std::pair<X, Y> to_std_pair(UInt_pair const self) noexcept {
     return std::pair(x(self), y(self));
@@ -102,12 +185,14 @@ class UInt_pair {
            class A1,                                                           \
            class AUint,                                                        \
            auto Anum,                                                          \
+           class AEnc,                                                         \
            class B0,                                                           \
            class B1,                                                           \
            class BUint,                                                        \
-           auto Bnum>                                                          \
-  inline auto operator op(const UInt_pair<A0, A1, AUint, Anum>& a,             \
-                          const UInt_pair<B0, B1, BUint, Bnum>& b)             \
+           auto Bnum,                                                          \
+           class BEnc>                                                         \
+  inline auto operator op(const UInt_pair<A0, A1, AUint, Anum, AEnc>& a,       \
+                          const UInt_pair<B0, B1, BUint, Bnum, BEnc>& b)       \
       BITPACK_EXPR_BODY(to_std_pair(a) op to_std_pair(b));
 
 // these defer to std::pair's relations
@@ -117,6 +202,19 @@ BITPACK_DEF_COMPARE(==)
 BITPACK_DEF_COMPARE(<=>)
 #undef BITPACK_DEF_COMPARE
 
+/**
+ * A UInt_pair whose packed word orders like the pair, even for signed and
+ * floating point elements. == and <=> compare the word. For floating point
+ * elements that means IEEE 754's total order (like std::strong_order): -0.0 <
+ * +0.0, and NaNs are ordered (and equal to themselves).
+ */
+template<class X,
+         class Y,
+         bits::unsigned_word    UInt,
+         size_t                 low_bit_count = bits::bit_sizeof<Y>>
+using ordered_pair =
+    UInt_pair<X, Y, UInt, low_bit_count, bits::ordered_encoding>;
+
 template<class X, class Y, size_t low_bit_count = bits::bit_sizeof<Y>>
 using uintptr_pair = UInt_pair<X, Y, uintptr_t, low_bit_count>;
 template<class X, class Y, size_t low_bit_count = bits::bit_sizeof<Y>>
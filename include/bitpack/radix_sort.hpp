@@ -0,0 +1,111 @@
+#ifndef BITPACK_RADIX_SORT_INCLUDE_GUARD
+#define BITPACK_RADIX_SORT_INCLUDE_GUARD
+
+#include "bits.hpp"
+#include "pair.hpp"
+#include "tagged_ptr.hpp"
+#include "variant_ptr.hpp"
+
+#include <algorithm>
+#include <array>
+#include <climits>
+#include <concepts>
+#include <cstddef>
+#include <span>
+#include <utility>
+#include <vector>
+
+namespace bitpack {
+/**
+ * Radix sort keys: an unsigned integer per object that orders the same way as
+ * the objects themselves. For the packed types here, that's (almost) just the
+ * packed word.
+ */
+// UInt_pairs order like their word when the encoding preserves both elements'
+// order (see ordered_pair)
+template<class X, class Y, class UInt, size_t low_bit_count, class Encoding>
+requires(UInt_pair<X, Y, UInt, low_bit_count, Encoding>::is_word_ordered) //
+    inline constexpr UInt order_key(
+        UInt_pair<X, Y, UInt, low_bit_count, Encoding> const pair) noexcept {
+  return pair.word();
+}
+// tagged_ptrs order by tag, then by address
+template<class Ptr,
+         class Tag,
+         size_t    tag_bits,
+         uintptr_t ptr_replacement_bits,
+         class Storage>
+inline constexpr uintptr_t order_key(
+    tagged_ptr<Ptr, Tag, tag_bits, ptr_replacement_bits, Storage> const
+        p) noexcept {
+  return Storage::order_key(p.word());
+}
+// variant_ptrs order by index, then by address
+template<class... Ts>
+inline constexpr uintptr_t order_key(variant_ptr<Ts...> const v) noexcept {
+  using storage = tag_storage::low<variant_ptr<Ts...>::tag_bits>;
+  return storage::order_key(v.word());
+}
+
+namespace impl {
+template<class T> concept RadixSortable = requires(T const x) {
+  { order_key(x) } -> std::unsigned_integral;
+};
+
+/**
+ * LSD radix sort, one byte of the key per pass. One read builds the
+ * histograms for every pass, then passes where every key has the same byte
+ * (e.g. unused high bits) are skipped. Stable.
+ */
+template<class T, class KeyFn>
+inline void radix_sort_by(std::span<T> const items, KeyFn const key) {
+  using Key = decltype(key(std::declval<T const&>()));
+  constexpr std::size_t radix_bits = CHAR_BIT;
+  constexpr std::size_t radix      = std::size_t{1} << radix_bits;
+  constexpr std::size_t passes =
+      (bits::bit_sizeof<Key> + radix_bits - 1) / radix_bits;
+  auto const digit = [](Key const k, std::size_t const pass) {
+    return static_cast<std::size_t>((k >> (pass * radix_bits)) & (radix - 1));
+  };
+
+  auto const n = items.size();
+  if(n < 2) return;
+
+  std::array<std::array<std::size_t, radix>, passes> counts{};
+  for(auto const& x : items) {
+    auto const k = key(x);
+    for(std::size_t pass = 0; pass < passes; ++pass)
+      ++counts[pass][digit(k, pass)];
+  }
+
+  std::vector<T> buffer(n);
+  std::span<T>   from = items, to = buffer;
+  for(std::size_t pass = 0; pass < passes; ++pass) {
+    auto& count = counts[pass];
+    // every key has the same digit: this pass wouldn't move anything
+    if(count[digit(key(from[0]), pass)] == n) continue;
+
+    std::size_t offset = 0;
+    for(auto& c : count) offset += std::exchange(c, offset);
+    for(auto const& x : from) to[count[digit(key(x), pass)]++] = x;
+    std::swap(from, to);
+  }
+  if(from.data() != items.data()) std::ranges::copy(from, items.begin());
+}
+} // namespace impl
+
+/**
+ * Sort packed objects (UInt_pairs whose word is ordered, tagged_ptrs, or
+ * variant_ptrs) by radix sorting their packed words. The result is the same
+ * as std::stable_sort with
+ * - lexicographic order for UInt_pairs
+ * - order by tag, then address, for tagged_ptrs
+ * - order by index, then address, for variant_ptrs
+ */
+template<impl::RadixSortable T>
+inline void radix_sort(std::span<T> const items) {
+  impl::radix_sort_by(items, [](T const& x) { return order_key(x); });
+}
+} // namespace bitpack
+
+#endif // BITPACK_RADIX_SORT_INCLUDE_GUARD
@@ -0,0 +1,238 @@
+#ifndef BITPACK_RECLAIM_INCLUDE_GUARD
+#define BITPACK_RECLAIM_INCLUDE_GUARD
+
+#include "tagged_ptr.hpp"
+#include "variant_ptr.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <concepts>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <utility>
+#include <vector>
+
+namespace bitpack {
+/**
+ * Safe memory reclamation hooks for lock-free structures. A structure that
+ * unlinks a node can't free it right away: other threads may still be reading
+ * it. A Reclaimer decides when that's safe. It has
+ * - r.pin(): a guard the thread holds for the duration of one operation.
+ *   guard.protect(slot, src) loads the atomic src and keeps what it points to
+ *   alive until the guard is destroyed or that slot is used again. An
+ *   operation uses slots 0 to 2.
+ * - r.retire(p): p (a pointer to a heap object) was unlinked. Delete it once
+ *   no guard can reach it.
+ *
+ * The reclaimers here also accept tagged_ptrs and variant_ptrs, both for
+ * protect and retire: the tag is stripped off and the pointer it was stored
+ * with is what gets protected or deleted (as its own type, for variant_ptrs).
+ */
+template<class R> concept Reclaimer = requires(R& r, int* p) {
+  { r.pin().protect(std::size_t{0}, std::declval<std::atomic<int*>&>()) }
+      -> std::same_as<int*>;
+  r.retire(p);
+};
+
+namespace impl {
+// the address a (possibly tagged) pointer points to
+template<class T> inline void const* address_of(T* const p) noexcept {
+  return p;
+}
+template<class Ptr, class Tag, size_t bits, uintptr_t replacement, class S>
+inline void const*
+    address_of(tagged_ptr<Ptr, Tag, bits, replacement, S> const p) noexcept {
+  return address_of(p.ptr());
+}
+template<class... Ts>
+inline void const* address_of(variant_ptr<Ts...> const v) noexcept {
+  return bitpack::visit([](auto const p) { return address_of(p); }, v);
+}
+
+// a retired object and how to delete it, in an intrusive list
+struct retired {
+  void*    ptr;
+  void     (*deleter)(void*);
+  retired* next = nullptr;
+
+  template<class T> static retired* make(T* const p) {
+    return new retired{const_cast<std::remove_cv_t<T>*>(p),
+                       [](void* const x) { delete static_cast<T*>(x); }};
+  }
+  template<class Ptr, class Tag, size_t bits, uintptr_t replacement, class S>
+  static retired* make(tagged_ptr<Ptr, Tag, bits, replacement, S> const p) {
+    return make(p.ptr());
+  }
+  template<class... Ts> static retired* make(variant_ptr<Ts...> const v) {
+    return bitpack::visit([](auto const p) { return make(p); }, v);
+  }
+  // delete every object in the list starting at `list`, and the list
+  static void free_all(retired* list) noexcept {
+    while(list != nullptr) {
+      list->deleter(list->ptr);
+      delete std::exchange(list, list->next);
+    }
+  }
+};
+
+// Do two values of a pointer-like type have the same bits?
+template<class T> inline bool same_bits(T const a, T const b) noexcept {
+  return bits::bit_cast<uintptr_t>(a) == bits::bit_cast<uintptr_t>(b);
+}
+
+/**
+ * Hands each thread its own Record for one domain (an epoch or hazard pointer
+ * domain), found through a thread_local cache. Records belong to the registry
+ * and live until it's destroyed. When a thread exits, its records are
+ * released (Record::release()) and can be taken over by other threads.
+ *
+ * Record needs public members `std::atomic<bool> in_use` (initially true),
+ * `Record* next` and `void release() noexcept`.
+ */
+template<class Record> class thread_registry {
+ public:
+  thread_registry() : id_{next_id()} {
+    std::scoped_lock const lock{live_mutex()};
+    live_ids().push_back(id_);
+  }
+  thread_registry(thread_registry const&) = delete;
+  thread_registry& operator=(thread_registry const&) = delete;
+  ~thread_registry() {
+    {
+      // after this, exiting threads won't touch our records
+      std::scoped_lock const lock{live_mutex()};
+      std::erase(live_ids(), id_);
+    }
+    for(Record* r = head_.load(); r != nullptr;)
+      delete std::exchange(r, r->next);
+  }
+
+  /**
+   * This thread's record
+   */
+  Record& local() {
+    auto& entries = local_entries();
+    for(auto const& e : entries)
+      if(e.registry == id_) return *static_cast<Record*>(e.record);
+
+    Record* const          r = acquire();
+    std::scoped_lock const lock{live_mutex()};
+    std::erase_if(entries,
+                  [](entry const& e) { return !is_live(e.registry); });
+    entries.push_back({id_, r, &release});
+    return *r;
+  }
+
+  /**
+   * Call f on every record (in use or not)
+   */
+  template<class F> void for_each(F const f) const {
+    for(Record* r = head_.load(std::memory_order_acquire); r != nullptr;
+        r         = r->next)
+      f(*r);
+  }
+
+ private:
+  Record* acquire() {
+    for(Record* r = head_.load(std::memory_order_acquire); r != nullptr;
+        r         = r->next) {
+      bool in_use = false;
+      if(!r->in_use.load(std::memory_order_relaxed)
+         && r->in_use.compare_exchange_strong(in_use,
+                                              true,
+                                              std::memory_order_acquire))
+        return r;
+    }
+    auto* const r = new Record;
+    r->next       = head_.load(std::memory_order_relaxed);
+    while(!head_.compare_exchange_weak(r->next,
+                                       r,
+                                       std::memory_order_release,
+                                       std::memory_order_relaxed)) {}
+    return r;
+  }
+
+  static void release(void* const x) noexcept {
+    auto* const record = static_cast<Record*>(x);
+    record->release();
+    record->in_use.store(false, std::memory_order_release);
+  }
+
+  // Registries are told apart by id rather than address, since a new one can
+  // reuse a destroyed one's address while threads still cache the old one.
+  struct entry {
+    std::uint64_t registry;
+    void*         record;
+    void          (*release)(void*);
+  };
+  struct thread_entries : std::vector<entry> {
+    ~thread_entries() {
+      std::scoped_lock const lock{live_mutex()};
+      for(auto const& e : *this)
+        if(is_live(e.registry)) e.release(e.record);
+    }
+  };
+  static thread_entries& local_entries() {
+    static thread_local thread_entries entries;
+    return entries;
+  }
+
+  static std::uint64_t next_id() noexcept {
+    static std::atomic<std::uint64_t> ids{0};
+    return ids.fetch_add(1, std::memory_order_relaxed);
+  }
+  static std::mutex& live_mutex() noexcept {
+    static std::mutex mutex;
+    return mutex;
+  }
+  static std::vector<std::uint64_t>& live_ids() noexcept {
+    static std::vector<std::uint64_t> ids;
+    return ids;
+  }
+  static bool is_live(std::uint64_t const id) noexcept {
+    return std::ranges::find(live_ids(), id) != live_ids().end();
+  }
+
+  std::atomic<Record*> head_{nullptr};
+  std::uint64_t        id_;
+};
+} // namespace impl
+
+/**
+ * The simplest Reclaimer: keep every retired object until the reclaimer is
+ * destroyed. Guards cost nothing, but memory grows with the number of
+ * removals. Fine for structures that are mostly read or don't live long.
+ */
+class reclaim_on_destruction {
+ public:
+  struct guard {
+    template<class Atomic>
+    auto protect(std::size_t, Atomic const& src) const noexcept {
+      return src.load(std::memory_order_acquire);
+    }
+  };
+
+  constexpr reclaim_on_destruction() noexcept = default;
+  reclaim_on_destruction(reclaim_on_destruction&& other) noexcept
+      : retired_{other.retired_.exchange(nullptr)} {}
+  reclaim_on_destruction& operator=(reclaim_on_destruction&&) = delete;
+  ~reclaim_on_destruction() { impl::retired::free_all(retired_.load()); }
+
+  guard pin() const noexcept { return {}; }
+
+  void retire(auto const p) {
+    auto* const r = impl::retired::make(p);
+    r->next       = retired_.load(std::memory_order_relaxed);
+    while(!retired_.compare_exchange_weak(r->next,
+                                          r,
+                                          std::memory_order_release,
+                                          std::memory_order_relaxed)) {}
+  }
+
+ private:
+  std::atomic<impl::retired*> retired_{nullptr};
+};
+} // namespace bitpack
+
+#endif // BITPACK_RECLAIM_INCLUDE_GUARD
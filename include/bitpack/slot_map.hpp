@@ -0,0 +1,206 @@
+#ifndef BITPACK_SLOT_MAP_INCLUDE_GUARD
+#define BITPACK_SLOT_MAP_INCLUDE_GUARD
+
+#include "macros.hpp"
+#include "bits.hpp"
+#include "pair.hpp"
+
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <span>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+
+namespace bitpack {
+/**
+ * A container that hands out handles to its elements instead of keys.
+ * Handles are (slot index, generation) pairs packed into one Word.
+ * Erasing an element bumps its slot's generation, so old handles to that slot
+ * stop working, even once the slot is reused.
+ *
+ * Each slot remembers the one handle that's currently valid for it, so
+ * checking a handle is one integer compare (after the bounds check). The
+ * elements themselves are stored densely, in no particular order, so
+ * iterating over them is iterating over a vector.
+ *
+ * T = the element type
+ * generation_bits = how many bits of the handle are the generation. The rest
+ * are the slot index. Generations wrap around, so a handle can come back to
+ * life after its slot was reused 2^generation_bits times.
+ * Word = the unsigned int type a handle is packed into
+ * Index = the unsigned int type of slot indices (and generations), which is
+ * also what the slot map stores per element and per slot
+ *
+ * So slot_map<T, 8, std::uint32_t> has 4 byte handles with 24 bits of index
+ * (up to 2^24 slots) and 8 bits of generation.
+ */
+template<class T,
+         std::size_t            generation_bits = 32,
+         bits::unsigned_word    Word            = std::uint64_t,
+         std::unsigned_integral Index           = std::uint32_t>
+class slot_map {
+ public:
+  // x = slot index, y = generation
+  using handle         = UInt_pair<Index, Index, Word, generation_bits>;
+  using index_type     = Index;
+  using value_type     = T;
+  using size_type      = std::size_t;
+  using iterator       = typename std::vector<T>::iterator;
+  using const_iterator = typename std::vector<T>::const_iterator;
+
+ private:
+  static_assert(generation_bits <= bits::bit_sizeof<Index>,
+                "The generation has to fit in an Index");
+  static_assert(sizeof(Index) <= sizeof(std::size_t));
+  static constexpr std::size_t index_bits =
+      bits::bit_sizeof<Word> - generation_bits;
+  static constexpr Index no_slot = std::numeric_limits<Index>::max();
+  static constexpr Index generation_mask =
+      bits::low_mask<Index>(generation_bits);
+
+  struct slot {
+    handle current;       // the handle that's valid for this slot
+    Index  dense_or_next; // the element's index, or the next free slot
+  };
+
+ public:
+  /**
+   * How many slots there can be: as many indices as fit in the handle's
+   * index bits, and in an Index (except no_slot, which marks the end of the
+   * free list)
+   */
+  static constexpr std::size_t max_slots =
+      index_bits < bits::bit_sizeof<Index> ? std::size_t{1} << index_bits
+                                           : std::size_t{no_slot};
+
+  constexpr slot_map() = default;
+
+  /**
+   * Add an element and return its handle. Throws std::length_error if it
+   * needs a new slot and there are already max_slots.
+   */
+  handle insert(T const& value) { return emplace(value); }
+  handle insert(T&& value) { return emplace(std::move(value)); }
+  template<class... Args> handle emplace(Args&&... args) {
+    if(free_head_ == no_slot) {
+      if(slots_.size() >= max_slots)
+        throw std::length_error{"slot_map has run out of slot indices"};
+      free_head_ = static_cast<Index>(slots_.size());
+      slots_.push_back({handle{free_head_, 0}, no_slot});
+    }
+    auto const index = free_head_;
+    dense_to_slot_.push_back(index);
+    try {
+      values_.emplace_back(std::forward<Args>(args)...);
+    } catch(...) {
+      dense_to_slot_.pop_back();
+      throw;
+    }
+    auto& s         = slots_[index];
+    free_head_      = s.dense_or_next;
+    s.dense_or_next = static_cast<Index>(values_.size() - 1);
+    return s.current;
+  }
+
+  /**
+   * Remove the element h refers to. Returns false if h is stale.
+   */
+  bool erase(handle const h) {
+    if(!contains(h)) return false;
+    auto&      s     = slots_[h.x()];
+    auto const dense = s.dense_or_next;
+    // move the last element into the hole
+    if(dense != values_.size() - 1) {
+      values_[dense]                              = std::move(values_.back());
+      dense_to_slot_[dense]                       = dense_to_slot_.back();
+      slots_[dense_to_slot_[dense]].dense_or_next = dense;
+    }
+    values_.pop_back();
+    dense_to_slot_.pop_back();
+
+    s.current       = handle{h.x(), next_generation(h.y())};
+    s.dense_or_next = std::exchange(free_head_, h.x());
+    return true;
+  }
+
+  /**
+   * Does h refer to an element?
+   */
+  constexpr bool contains(handle const h) const noexcept {
+    return h.x() < slots_.size()
+           && slots_[h.x()].current.word() == h.word();
+  }
+  /**
+   * The element h refers to, or nullptr if h is stale
+   */
+  constexpr T* find(handle const h) noexcept {
+    return contains(h) ? &values_[slots_[h.x()].dense_or_next] : nullptr;
+  }
+  constexpr T const* find(handle const h) const noexcept {
+    return contains(h) ? &values_[slots_[h.x()].dense_or_next] : nullptr;
+  }
+  /**
+   * The element h refers to. h must be valid.
+   */
+  constexpr T& operator[](handle const h) noexcept(impl::is_assert_off) {
+    BITPACK_ASSERT(contains(h));
+    return values_[slots_[h.x()].dense_or_next];
+  }
+  constexpr T const& operator[](handle const h) const
+      noexcept(impl::is_assert_off) {
+    BITPACK_ASSERT(contains(h));
+    return values_[slots_[h.x()].dense_or_next];
+  }
+
+  constexpr size_type size() const noexcept { return values_.size(); }
+  constexpr bool      empty() const noexcept { return values_.empty(); }
+  void                reserve(size_type const n) {
+    values_.reserve(n);
+    dense_to_slot_.reserve(n);
+    slots_.reserve(n);
+  }
+  /**
+   * Remove every element. Every handle handed out so far becomes stale.
+   */
+  void clear() {
+    for(auto const index : dense_to_slot_) {
+      auto& s         = slots_[index];
+      s.current       = handle{index, next_generation(s.current.y())};
+      s.dense_or_next = std::exchange(free_head_, index);
+    }
+    values_.clear();
+    dense_to_slot_.clear();
+  }
+
+  /**
+   * Iterate over the elements (densely stored, in no particular order)
+   */
+  iterator       begin() noexcept { return values_.begin(); }
+  iterator       end() noexcept { return values_.end(); }
+  const_iterator begin() const noexcept { return values_.begin(); }
+  const_iterator end() const noexcept { return values_.end(); }
+  std::span<T>       values() noexcept { return values_; }
+  std::span<T const> values() const noexcept { return values_; }
+  /**
+   * The handle of values()[i]
+   */
+  handle handle_at(size_type const i) const noexcept(impl::is_assert_off) {
+    BITPACK_ASSERT(i < size());
+    return slots_[dense_to_slot_[i]].current;
+  }
+
+ private:
+  static constexpr Index next_generation(Index const generation) noexcept {
+    return static_cast<Index>((generation + 1u) & generation_mask);
+  }
+
+  std::vector<T>     values_;
+  std::vector<Index> dense_to_slot_; // parallel to values_
+  std::vector<slot>  slots_;
+  Index              free_head_ = no_slot;
+};
+} // namespace bitpack
+
+#endif // BITPACK_SLOT_MAP_INCLUDE_GUARD
@@ -0,0 +1,229 @@
+#ifndef BITPACK_SWAR_INCLUDE_GUARD
+#define BITPACK_SWAR_INCLUDE_GUARD
+
+#include "macros.hpp"
+#include "bits.hpp"
+
+#include <bit>
+#include <concepts>
+#include <cstddef>
+#include <type_traits>
+
+namespace bitpack { namespace swar {
+/**
+ * SIMD within a register: arithmetic on a word as a row of width-bit unsigned
+ * lanes, all of them at once, in a handful of ALU ops and without branches.
+ * Eight saturating 8 bit counters in a std::uint64_t are bumped with one
+ * increment_saturate, say.
+ *
+ * Lane 0 is the lowest width bits. A packed_vector<T, width>'s words() (when
+ * width divides 64), or a packed_struct of equal width fields, are rows of
+ * lanes like these.
+ *
+ * The comparisons return a lane mask: the top bit of each lane for which the
+ * comparison holds. fill_lanes turns that into all of the lane's bits, for
+ * blending; first_lane and count_lanes read it.
+ */
+template<class UInt, std::size_t width>
+concept lane_word = std::unsigned_integral<UInt> && 0 < width
+                    && bits::bit_sizeof<UInt> % width == 0;
+
+template<class UInt, std::size_t width>
+requires lane_word<UInt, width>
+inline constexpr std::size_t lane_count = bits::bit_sizeof<UInt> / width;
+
+/**
+ * The lowest (highest) bit of every lane
+ */
+template<class UInt, std::size_t width>
+requires lane_word<UInt, width>
+inline constexpr UInt low_bits = static_cast<UInt>(
+    static_cast<UInt>(~UInt{0}) / bits::low_mask<UInt>(width));
+template<class UInt, std::size_t width>
+requires lane_word<UInt, width>
+inline constexpr UInt high_bits =
+    static_cast<UInt>(low_bits<UInt, width> << (width - 1));
+
+/**
+ * value in every lane
+ */
+template<std::size_t width, class UInt>
+requires lane_word<UInt, width>
+inline constexpr UInt broadcast(UInt const value) noexcept(
+    impl::is_assert_off) {
+  BITPACK_ASSERT(value <= bits::low_mask<UInt>(width));
+  return static_cast<UInt>(low_bits<UInt, width> * value);
+}
+
+/**
+ * Lane i of x
+ */
+template<std::size_t width, class UInt>
+requires lane_word<UInt, width>
+inline constexpr UInt lane(UInt const        x,
+                           std::size_t const i) noexcept(impl::is_assert_off) {
+  BITPACK_ASSERT((i < lane_count<UInt, width>));
+  return static_cast<UInt>((x >> (i * width)) & bits::low_mask<UInt>(width));
+}
+/**
+ * x with lane i replaced by value
+ */
+template<std::size_t width, class UInt>
+requires lane_word<UInt, width>
+inline constexpr UInt with_lane(UInt const                       x,
+                                std::size_t const                i,
+                                std::type_identity_t<UInt> const value) //
+    noexcept(impl::is_assert_off) {
+  BITPACK_ASSERT((i < lane_count<UInt, width>));
+  BITPACK_ASSERT(value <= bits::low_mask<UInt>(width));
+  auto const shift = i * width;
+  return static_cast<UInt>((x & ~(bits::low_mask<UInt>(width) << shift))
+                           | (value << shift));
+}
+
+/**
+ * a + b in each lane, wrapping around (no carry into the next lane)
+ */
+template<std::size_t width, class UInt>
+requires lane_word<UInt, width>
+inline constexpr UInt add(UInt const                       a,
+                          std::type_identity_t<UInt> const b) noexcept {
+  constexpr auto high = high_bits<UInt, width>;
+  constexpr auto low  = static_cast<UInt>(~high);
+  // add without the top bits, so nothing carries out; then put them back
+  return static_cast<UInt>(static_cast<UInt>((a & low) + (b & low))
+                           ^ ((a ^ b) & high));
+}
+/**
+ * a - b in each lane, wrapping around (no borrow from the next lane)
+ */
+template<std::size_t width, class UInt>
+requires lane_word<UInt, width>
+inline constexpr UInt sub(UInt const                       a,
+                          std::type_identity_t<UInt> const b) noexcept {
+  constexpr auto high = high_bits<UInt, width>;
+  constexpr auto low  = static_cast<UInt>(~high);
+  // borrow from top bits that are all set, then fix them up
+  return static_cast<UInt>(static_cast<UInt>((a | high) - (b & low))
+                           ^ ((a ^ ~b) & high));
+}
+
+/**
+ * Turn a lane mask (the top bit of some lanes) into all the bits of those
+ * lanes
+ */
+template<std::size_t width, class UInt>
+requires lane_word<UInt, width>
+inline constexpr UInt fill_lanes(UInt const mask) noexcept {
+  // (each top bit minus the same lane's bottom bit sets the bits in between)
+  return static_cast<UInt>(static_cast<UInt>(mask - (mask >> (width - 1)))
+                           | mask);
+}
+
+/**
+ * a + b in each lane, stopping at the lane's maximum
+ */
+template<std::size_t width, class UInt>
+requires lane_word<UInt, width>
+inline constexpr UInt
+    add_saturate(UInt const a, std::type_identity_t<UInt> const b) noexcept {
+  auto const sum = add<width>(a, b);
+  // the lanes that carried out of their top bit
+  auto const carries = static_cast<UInt>(
+      ((a & b) | ((a | b) & static_cast<UInt>(~sum))) & high_bits<UInt, width>);
+  return static_cast<UInt>(sum | fill_lanes<width>(carries));
+}
+/**
+ * a - b in each lane, stopping at 0
+ */
+template<std::size_t width, class UInt>
+requires lane_word<UInt, width>
+inline constexpr UInt
+    sub_saturate(UInt const a, std::type_identity_t<UInt> const b) noexcept {
+  auto const difference = sub<width>(a, b);
+  auto const borrows    = static_cast<UInt>(
+      ((~a & b) | (~(a ^ b) & difference)) & high_bits<UInt, width>);
+  return static_cast<UInt>(difference
+                           & static_cast<UInt>(~fill_lanes<width>(borrows)));
+}
+/**
+ * Add 1 to the lanes in the lane mask `which` (all of them by default) that
+ * aren't at their maximum. Cheaper than add_saturate: only full lanes can
+ * overflow, so they're the only ones to leave out.
+ */
+template<std::size_t width, class UInt>
+requires lane_word<UInt, width>
+inline constexpr UInt increment_saturate(
+    UInt const                       x,
+    std::type_identity_t<UInt> const which = high_bits<UInt, width>) noexcept {
+  constexpr auto high = high_bits<UInt, width>;
+  constexpr auto low  = static_cast<UInt>(~high);
+  // a full lane's low bits carry into its top bit, which is also set
+  auto const full = static_cast<UInt>(
+      static_cast<UInt>((x & low) + low_bits<UInt, width>) & x & high);
+  return static_cast<UInt>(
+      x + (static_cast<UInt>(which & ~full) >> (width - 1)));
+}
+
+/**
+ * The lane mask of x's lanes that are 0. Exact: no false positives from
+ * borrows, unlike the shorter (x - low_bits) & ~x & high_bits.
+ */
+template<std::size_t width, class UInt>
+requires lane_word<UInt, width>
+inline constexpr UInt zero_lanes(UInt const x) noexcept {
+  constexpr auto low = static_cast<UInt>(~high_bits<UInt, width>);
+  // the top bit gets set if any lower bit is (with nothing carrying out)
+  auto const nonzero =
+      static_cast<UInt>(static_cast<UInt>((x & low) + low) | x);
+  return static_cast<UInt>(~(nonzero | low));
+}
+/**
+ * The lane mask of the lanes where a == b
+ */
+template<std::size_t width, class UInt>
+requires lane_word<UInt, width>
+inline constexpr UInt equal(UInt const                       a,
+                            std::type_identity_t<UInt> const b) noexcept {
+  return zero_lanes<width>(static_cast<UInt>(a ^ b));
+}
+/**
+ * The lane mask of the lanes where a < b (as unsigned numbers)
+ */
+template<std::size_t width, class UInt>
+requires lane_word<UInt, width>
+inline constexpr UInt less(UInt const                       a,
+                           std::type_identity_t<UInt> const b) noexcept {
+  // the lanes where a - b borrows
+  auto const difference = sub<width>(a, b);
+  return static_cast<UInt>(((~a & b) | (~(a ^ b) & difference))
+                           & high_bits<UInt, width>);
+}
+
+/**
+ * The index of the lowest lane in a lane mask, or lane_count if it's empty
+ */
+template<std::size_t width, class UInt>
+requires lane_word<UInt, width>
+inline constexpr std::size_t first_lane(UInt const mask) noexcept {
+  return static_cast<std::size_t>(std::countr_zero(mask)) / width;
+}
+/**
+ * How many lanes are in a lane mask
+ */
+template<std::size_t width, class UInt>
+requires lane_word<UInt, width>
+inline constexpr std::size_t count_lanes(UInt const mask) noexcept {
+  return static_cast<std::size_t>(std::popcount(mask));
+}
+/**
+ * The index of x's lowest lane that's 0, or lane_count if none is
+ */
+template<std::size_t width, class UInt>
+requires lane_word<UInt, width>
+inline constexpr std::size_t find_first_zero(UInt const x) noexcept {
+  return first_lane<width>(zero_lanes<width>(x));
+}
+}} // namespace bitpack::swar
+
+#endif // BITPACK_SWAR_INCLUDE_GUARD
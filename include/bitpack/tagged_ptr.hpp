@@ -2,7 +2,7 @@
 #define BITPACK_TAGGED_PTR_INCLUDE_GUARD
 
 #include "traits.hpp"
-#include "pair.hpp"
+#include "bits.hpp"
 
 #include <cstddef>
 #include <bit>
@@ -10,6 +10,111 @@
 #include <concepts>
 
 namespace bitpack {
+/**
+ * Policies for where a tagged_ptr keeps its tag inside the pointer's word.
+ * Each one says how many tag bits it has, how to pack a pointer and a tag
+ * into a word and get them back out, and how to turn a word into a key that
+ * orders by tag, then address.
+ */
+namespace tag_storage {
+namespace impl {
+template<std::size_t bits>
+inline constexpr uintptr_t low_mask = (uintptr_t{1} << bits) - 1;
+
+// Fill the top `bits` bits back in with copies of the highest bit that's left
+// (this is how x86-64 and AArch64 expect their "canonical" addresses).
+template<std::size_t bits>
+inline constexpr uintptr_t sign_extend(uintptr_t const x) noexcept {
+  return bitpack::bits::bit_cast<uintptr_t>(
+      bitpack::bits::bit_cast<intptr_t>(x << bits) >> bits);
+}
+} // namespace impl
+
+/**
+ * Store the tag in the lowest `bits` bits. They're free as long as the
+ * pointee's alignment is at least 2^bits. Optionally, fill the low bits of the
+ * pointer back in with ptr_replacement_bits.
+ */
+template<std::size_t bits, uintptr_t ptr_replacement_bits = 0u> struct low {
+  static constexpr std::size_t tag_bits =
+      std::max<std::size_t>(bits, 1); // a 0 bit tag is no tag at all
+
+  static constexpr uintptr_t pack(uintptr_t const ptr,
+                                  uintptr_t const tag) noexcept {
+    return (ptr & ~impl::low_mask<tag_bits>) | (tag & impl::low_mask<tag_bits>);
+  }
+  static constexpr uintptr_t ptr(uintptr_t const word) noexcept {
+    return (word & ~impl::low_mask<tag_bits>) | ptr_replacement_bits;
+  }
+  static constexpr uintptr_t tag(uintptr_t const word) noexcept {
+    return word & impl::low_mask<tag_bits>;
+  }
+  // rearranged so keys order by tag, then by address
+  static constexpr uintptr_t order_key(uintptr_t const word) noexcept {
+    return std::rotr(word, tag_bits);
+  }
+};
+
+/**
+ * Store the tag in the highest `bits` bits. On x86-64 and AArch64 user space
+ * pointers only use the low 48 bits, so the top 16 are free for any pointer,
+ * regardless of alignment. The address is made canonical again (sign extended)
+ * when the pointer is read back.
+ */
+template<std::size_t bits = 16> struct high {
+  static_assert(bitpack::bits::bit_sizeof<uintptr_t> == 64,
+                "High tag bits only make sense for 64 bit pointers");
+  static_assert(0 < bits && bits <= 16,
+                "Only the top 16 bits of a pointer are free");
+  static constexpr std::size_t tag_bits = bits;
+
+  static constexpr uintptr_t pack(uintptr_t const ptr,
+                                  uintptr_t const tag) noexcept {
+    return (ptr & impl::low_mask<64 - bits>) | (tag << (64 - bits));
+  }
+  static constexpr uintptr_t ptr(uintptr_t const word) noexcept {
+    return impl::sign_extend<bits>(word);
+  }
+  static constexpr uintptr_t tag(uintptr_t const word) noexcept {
+    return word >> (64 - bits);
+  }
+  // rearranged so keys order by tag, then by address
+  static constexpr uintptr_t order_key(uintptr_t const word) noexcept {
+    return word; // already is
+  }
+};
+
+/**
+ * Use both: the lowest `low_bits` bits of the tag go in the pointer's free
+ * low (alignment) bits and the rest go in its top `high_bits` bits.
+ */
+template<std::size_t high_bits, std::size_t low_bits> struct high_low {
+  static_assert(bitpack::bits::bit_sizeof<uintptr_t> == 64,
+                "High tag bits only make sense for 64 bit pointers");
+  static_assert(0 < high_bits && high_bits <= 16,
+                "Only the top 16 bits of a pointer are free");
+  static constexpr std::size_t tag_bits = high_bits + low_bits;
+
+  static constexpr uintptr_t pack(uintptr_t const ptr,
+                                  uintptr_t const tag) noexcept {
+    return (ptr & impl::low_mask<64 - high_bits> & ~impl::low_mask<low_bits>)
+           | (tag & impl::low_mask<low_bits>)
+           | ((tag >> low_bits) << (64 - high_bits));
+  }
+  static constexpr uintptr_t ptr(uintptr_t const word) noexcept {
+    return impl::sign_extend<high_bits>(word) & ~impl::low_mask<low_bits>;
+  }
+  static constexpr uintptr_t tag(uintptr_t const word) noexcept {
+    return ((word >> (64 - high_bits)) << low_bits)
+           | (word & impl::low_mask<low_bits>);
+  }
+  // rearranged so keys order by tag, then by address
+  static constexpr uintptr_t order_key(uintptr_t const word) noexcept {
+    return (tag(word) << (64 - tag_bits))
+           | ((word & impl::low_mask<64 - high_bits>) >> low_bits);
+  }
+};
+} // namespace tag_storage
 
 /**
  * Holds a pointer(`T*`) and puts a tag(`Tag`) in the low bits(the number
@@ -22,18 +127,29 @@ namespace bitpack {
  * tag_bits_ = the number of bits needed to store the tag
  * ptr_replacement_bits = if the low bits of the pointer aren't 0, what should
  * they be filled in with?
+ * Storage = where the tag bits go (see tag_storage). You probably want the
+ * high_tagged_ptr or high_low_tagged_ptr aliases instead of setting this.
  */
 template<class Ptr,
          class Tag,
          size_t tag_bits_ = std::bit_width(alignof(traits::unptr_t<Ptr>) - 1),
-         uintptr_t ptr_replacement_bits = 0u>
+         uintptr_t ptr_replacement_bits = 0u,
+         class Storage = tag_storage::low<tag_bits_, ptr_replacement_bits>>
 class tagged_ptr {
  private:
   static constexpr bool holds_void = std::is_void_v<traits::unptr_t<Ptr>>;
 
  public:
-  static constexpr uintptr_t tag_bits =
-      std::max<uintptr_t>(tag_bits_, 1); // can't have 0 length bitfields :C
+  static constexpr uintptr_t tag_bits = Storage::tag_bits;
+  static_assert(tag_bits == std::max<uintptr_t>(tag_bits_, 1),
+                "The storage policy must have room for tag_bits_ bits");
+  /**
+   * The bits of the word that hold the tag
+   */
+  static constexpr uintptr_t tag_mask = Storage::pack(0, ~uintptr_t{0});
+  using pointer_type                  = Ptr;
+  using tag_type                      = Tag;
+
   constexpr tagged_ptr() = default;
   /**
    * ptr = the pointer to store
@@ -41,23 +157,65 @@ class tagged_ptr {
    */
   explicit constexpr tagged_ptr(Ptr const ptr,
                                 Tag const tag) noexcept(impl::is_assert_off)
-      : pair_{bits::bit_cast<uintptr_t>(ptr) >> tag_bits, tag} {
+      : word_{Storage::pack(bits::bit_cast<uintptr_t>(ptr),
+                            bits::as_UInt<uintptr_t>(tag))} {
     BITPACK_ASSERT(this->tag() == tag);
     BITPACK_ASSERT(this->ptr() == ptr);
   }
   constexpr static Ptr ptr(tagged_ptr const self) noexcept {
-    auto const pair = self.pair_;
-    return bits::bit_cast<Ptr>((decltype(pair)::x(pair) << tag_bits)
-                               | ptr_replacement_bits);
+    return bits::bit_cast<Ptr>(Storage::ptr(self.word_));
   }
   constexpr Ptr ptr() const noexcept { return ptr(*this); }
   constexpr static Tag tag(tagged_ptr const self) noexcept {
-    auto const pair = self.pair_;
-    return decltype(pair)::y(pair);
+    return bits::from_UInt<Tag>(Storage::tag(self.word_));
   }
 
   constexpr Tag tag() const noexcept { return tag(*this); }
 
+  /**
+   * A copy with the tag replaced. Only the tag's bits are touched (one mask
+   * and one or), the pointer isn't unpacked.
+   */
+  constexpr tagged_ptr with_tag(Tag const tag) const
+      noexcept(impl::is_assert_off) {
+    auto const p = from_word((word_ & ~tag_mask)
+                             | Storage::pack(0, bits::as_UInt<uintptr_t>(tag)));
+    BITPACK_ASSERT(p.tag() == tag);
+    return p;
+  }
+  /**
+   * A copy with the pointer replaced. The tag isn't unpacked.
+   */
+  constexpr tagged_ptr with_ptr(Ptr const ptr) const
+      noexcept(impl::is_assert_off) {
+    auto const p = from_word(Storage::pack(bits::bit_cast<uintptr_t>(ptr), 0)
+                             | (word_ & tag_mask));
+    BITPACK_ASSERT(p.ptr() == ptr);
+    return p;
+  }
+  constexpr void set_tag(Tag const tag) noexcept(impl::is_assert_off) {
+    *this = with_tag(tag);
+  }
+  constexpr void set_ptr(Ptr const ptr) noexcept(impl::is_assert_off) {
+    *this = with_ptr(ptr);
+  }
+
+  /**
+   * The packed bits (pointer and tag) of the tagged_ptr
+   */
+  constexpr static uintptr_t word(tagged_ptr const self) noexcept {
+    return self.word_;
+  }
+  constexpr uintptr_t word() const noexcept { return word(*this); }
+  /**
+   * Reinterpret packed bits (as returned by word()) as a tagged_ptr
+   */
+  constexpr static tagged_ptr from_word(uintptr_t const word) noexcept {
+    tagged_ptr self;
+    self.word_ = word;
+    return self;
+  }
+
   friend constexpr traits::unptr_t<Ptr>
       operator*(tagged_ptr const self) noexcept requires(!holds_void) {
     return *ptr(self);
@@ -77,7 +235,31 @@ class tagged_ptr {
   constexpr operator bool() { return *this == nullptr; }
 
  private:
-  uintptr_pair<uintptr_t, Tag, tag_bits> pair_;
+  uintptr_t word_;
 };
+
+/**
+ * A tagged_ptr that keeps its tag in the top `tag_bits` (at most 16) bits of
+ * the pointer, so it doesn't matter how the pointee is aligned. 64 bit only.
+ */
+template<class Ptr, class Tag, size_t tag_bits = 16>
+using high_tagged_ptr =
+    tagged_ptr<Ptr, Tag, tag_bits, 0u, tag_storage::high<tag_bits>>;
+
+/**
+ * A tagged_ptr that keeps its tag in both the top `high_bits` bits and the
+ * free low `low_bits` bits (by default, as many as the alignment allows).
+ * The tag has high_bits + low_bits bits in total. 64 bit only.
+ */
+template<class Ptr,
+         class Tag,
+         size_t high_bits = 16,
+         size_t low_bits = std::bit_width(alignof(traits::unptr_t<Ptr>) - 1)>
+using high_low_tagged_ptr =
+    tagged_ptr<Ptr,
+               Tag,
+               high_bits + low_bits,
+               0u,
+               tag_storage::high_low<high_bits, low_bits>>;
 } // namespace bitpack
 #endif // BITPACK_TAGGED_PTR_INCLUDE_GUARD
@@ -0,0 +1,140 @@
+#ifndef BITPACK_UNIQUE_VARIANT_PTR_INCLUDE_GUARD
+#define BITPACK_UNIQUE_VARIANT_PTR_INCLUDE_GUARD
+
+#include "macros.hpp"
+#include "variant_ptr.hpp"
+#include "workaround.hpp"
+
+#include <cstddef>
+#include <memory>
+#include <type_traits>
+#include <utility>
+
+namespace bitpack {
+/**
+ * Marks an alternative of a unique_variant_ptr that's freed with Deleter
+ * instead of delete: Deleter{}(ptr). Deleter has to be stateless (an empty
+ * class), so the unique_variant_ptr stays one word. Objects from a custom
+ * allocator or an object pool go this way.
+ */
+template<class Ptr, class Deleter> struct deleted_by;
+
+namespace impl {
+template<class T> struct owned_alternative {
+  using pointer = T;
+  using deleter = std::default_delete<std::remove_pointer_t<T>>;
+};
+template<class Ptr, class Deleter>
+struct owned_alternative<deleted_by<Ptr, Deleter>> {
+  using pointer = Ptr;
+  using deleter = Deleter;
+};
+} // namespace impl
+
+/**
+ * An owning variant_ptr, the way std::unique_ptr is an owning pointer: it's
+ * move-only and frees what it points to when it's destroyed or reset. The
+ * tag picks how: each alternative has its own deleter, so there's no need for
+ * a common base class with a virtual destructor, and it's still one word.
+ *
+ * get() is the non-owning variant_ptr, for get, holds_alternative, visit and
+ * so on. The pointees can be incomplete until the unique_variant_ptr is made
+ * or destroyed (like unique_ptr), so tree nodes can own their children.
+ *
+ * Ts = the pointer types it can hold, or deleted_by<pointer, Deleter> for
+ * ones that aren't freed with delete. The pointer types must be distinct:
+ * one pointer type can't have two deleters.
+ */
+template<class... Ts> class unique_variant_ptr {
+  template<class T>
+  using pointer_of = typename impl::owned_alternative<T>::pointer;
+  template<class T>
+  using deleter_of = typename impl::owned_alternative<T>::deleter;
+  using pointers = impl::typelist<pointer_of<Ts>...>;
+  using deleters = impl::typelist<deleter_of<Ts>...>;
+  static_assert((... && std::is_pointer_v<pointer_of<Ts>>),
+                "A unique_variant_ptr owns raw pointers");
+  static_assert((... && std::is_empty_v<deleter_of<Ts>>),
+                "Deleters must be stateless (empty classes)");
+  // the deleter is looked up by pointer type, so that has to pick one
+  static_assert(
+      [] {
+        unsigned i = 0;
+        return (... && (pointers::template find<pointer_of<Ts>> == i++));
+      }(),
+      "The alternatives' pointer types must be distinct");
+
+ public:
+  using view                     = variant_ptr<pointer_of<Ts>...>;
+  static constexpr auto size     = view::size;
+  static constexpr auto tag_bits = view::tag_bits;
+
+  constexpr unique_variant_ptr() noexcept = default;
+  constexpr unique_variant_ptr(std::nullptr_t) noexcept {}
+  /**
+   * Take ownership of ptr, which must be one of the alternatives' pointer
+   * types
+   */
+  template<class T>
+  requires(pointers::template has<T>) //
+      explicit unique_variant_ptr(T const ptr) noexcept(impl::is_assert_off)
+      : ptr_{view{ptr}} {}
+  unique_variant_ptr(unique_variant_ptr&& other) noexcept
+      : ptr_{other.release()} {}
+  unique_variant_ptr& operator=(unique_variant_ptr&& other) noexcept {
+    reset(other.release());
+    return *this;
+  }
+  ~unique_variant_ptr() { destroy(ptr_); }
+
+  /**
+   * Allocate a T with new and own it (for alternatives without a deleter)
+   */
+  template<class T, class... Args>
+  static unique_variant_ptr make(Args&&... args) {
+    return unique_variant_ptr{new T(std::forward<Args>(args)...)};
+  }
+
+  /**
+   * A non-owning view of the pointer
+   */
+  constexpr view get() const noexcept { return ptr_; }
+  constexpr auto index() const noexcept { return ptr_.index(); }
+  template<class T> constexpr bool holds_alternative() const noexcept {
+    return view::template holds_alternative<T>(ptr_);
+  }
+
+  /**
+   * Give up ownership, and return what was owned
+   */
+  view release() noexcept { return std::exchange(ptr_, view{}); }
+  /**
+   * Free what's owned (if anything) and own ptr instead
+   */
+  void reset(view const ptr = view{}) noexcept {
+    destroy(std::exchange(ptr_, ptr));
+  }
+
+  friend constexpr bool operator==(unique_variant_ptr const& p,
+                                   std::nullptr_t) noexcept {
+    return p.ptr_ == nullptr;
+  }
+  constexpr explicit operator bool() const noexcept {
+    return !(ptr_ == nullptr);
+  }
+
+ private:
+  static void destroy(view const ptr) noexcept {
+    if(ptr == nullptr) return;
+    bitpack::visit(
+        []<class T>(T const p) {
+          typename deleters::template nth<pointers::template find<T>>{}(p);
+        },
+        ptr);
+  }
+
+  view ptr_ = view{}; // (all zeros: a null pointer to the first alternative)
+};
+} // namespace bitpack
+
+#endif // BITPACK_UNIQUE_VARIANT_PTR_INCLUDE_GUARD
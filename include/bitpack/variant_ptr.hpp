@@ -9,6 +9,7 @@
 #include "hedley.h"
 
 #include <bit>
+#include <functional>
 #include <tuple>
 
 namespace bitpack {
@@ -93,6 +94,31 @@ struct visit_common_type_by_seq<variant_ptr, Func, std::index_sequence<i...>> {
       get<i>(std::declval<variant_ptr>())))...>;
 };
 
+/**
+ * A jump table for visit: entry I calls the visitor on alternative I. Looking
+ * up the tag in the table is O(1) no matter how many alternatives there are.
+ *
+ * Variant must provide static index(self) and get<I>(self).
+ */
+template<class R, class Func, class Variant, class seq> struct visit_table;
+
+template<class R, class Func, class Variant, auto... i>
+struct visit_table<R, Func, Variant, std::index_sequence<i...>> {
+ private:
+  template<auto n>
+  static constexpr R visit_nth(Func& visitor, Variant const self) {
+    return std::invoke(visitor, Variant::template get<n>(self));
+  }
+
+ public:
+  using entry = R (*)(Func&, Variant);
+  static constexpr entry table[] = {&visit_nth<i>...};
+
+  static constexpr R visit(Func& visitor, Variant const self) {
+    return table[Variant::index(self)](visitor, self);
+  }
+};
+
 } // namespace impl
 
 #if true
@@ -108,28 +134,38 @@ struct visit_common_type_by_seq<variant_ptr, Func, std::index_sequence<i...>> {
  * Ts = the pointer types your variant_ptr can hold.
  */
 template<class... Ts> class variant_ptr {
-  using types                    = impl::typelist<Ts...>;
-  static constexpr auto tag_bits = std::bit_width(types::size - 1);
+  using types     = impl::typelist<Ts...>;
+  using self_type = variant_ptr; // for BITPACK_UNROLL_VISIT
 
  public:
-  static constexpr auto size = types::size;
-  using Tag                  = int;
+  static constexpr auto size     = types::size;
+  static constexpr auto tag_bits = std::bit_width(types::size - 1);
+  using Tag                      = int;
   static constexpr Tag index(variant_ptr const self) noexcept {
     auto const ptr = self.ptr_;
     return decltype(ptr)::tag(ptr);
   }
   constexpr Tag index() const noexcept { return index(*this); }
 
+  /**
+   * The packed bits (pointer and tag) of the variant_ptr
+   */
+  static constexpr uintptr_t word(variant_ptr const self) noexcept {
+    return self.ptr_.word();
+  }
+  constexpr uintptr_t word() const noexcept { return word(*this); }
+
   constexpr variant_ptr() = default;
   // explicit(construct_variantptr_explicit<T>) <- why did this break
   template<class T>
   explicit(alignof(std::conditional_t<std::is_void_v<traits::unptr_t<T>>,
                                       char,
                                       traits::unptr_t<T>>)
-           <= tag_bits)
-      // ovrload resolution??? If alignment<= number. of tag bits, then
-      // inserting it into the variant risks clobbering meaningful low bits of
-      // the address. So we require it be done explicitly.
+           < (std::size_t{1} << tag_bits))
+      // ovrload resolution??? If the alignment doesn't leave tag_bits low bits
+      // free, then inserting it into the variant risks clobbering meaningful
+      // low bits of the address. So we require it be done explicitly (say,
+      // for pointers from a bitpack::arena, which aligns everything).
       constexpr variant_ptr(T ptr) noexcept(impl::is_assert_off)
       : ptr_{ptr, types::template find<T>} {}
 
@@ -199,12 +235,13 @@ template<class... Ts> class variant_ptr {
 #  define BITPACK_VISIT_CASE(n)                                                \
     case n: return std::invoke(visitor, get<n>(self));
   // this macro generates the visit implementation (via switch(index) ) for
-  // a variant that can take on n types
+  // a variant that can take on n types. It works in any class with a
+  // self_type alias, size, index, get and is_visit_noexcept.
 #  define BITPACK_UNROLL_VISIT(n)                                              \
     template<class R, class Func>                                              \
     requires(size == n) static constexpr R                                     \
-        visit(Func              visitor_,                                      \
-              variant_ptr const self) noexcept(is_visit_noexcept<Func>) {      \
+        visit(Func            visitor_,                                        \
+              self_type const self) noexcept(is_visit_noexcept<Func>) {        \
       auto const tag = index(self);                                            \
       /* idk clang thinks im not using this */                                 \
       [[maybe_unused]] auto const visitor = visitor_;                          \
@@ -218,24 +255,21 @@ template<class... Ts> class variant_ptr {
     BITPACK_REPEAT_OUTER(BITPACK_UNROLL_VISIT, BITPACK_UNROLL_VISIT_LIMIT)
   BITPACK_DIAGNOSTIC_POP
 
-  // fallback visit implementation
+  // fallback visit implementation: a table of function pointers indexed by the
+  // tag, so dispatch costs the same for any number of alternatives. The
+  // unrolled switch above is kept for small variants because there the
+  // compiler can inline the visitor into each case.
   template<class R, class Func>
   requires(size >= BITPACK_UNROLL_VISIT_LIMIT) //
       static constexpr R
       visit(Func              visitor,
             variant_ptr const self) noexcept(is_visit_noexcept<Func>) {
-    auto const tag = index(self);
-    BITPACK_ASSERT(0 <= tag && tag < bits::narrow<int>(size));
-
-    return [&]<auto... I>(std::index_sequence<I...>) {
-      R ret;
-      if((((tag == I) and (ret = std::invoke(visitor, get<I>(self)), true))
-          or ...))
-        return ret;
-      else
-        HEDLEY_UNREACHABLE();
-    }
-    (std::index_sequence_for<Ts...>{});
+    BITPACK_ASSERT(0 <= index(self) && index(self) < bits::narrow<int>(size));
+    return impl::visit_table<R,
+                             Func,
+                             variant_ptr,
+                             std::index_sequence_for<Ts...>>::visit(visitor,
+                                                                    self);
   }
 
   template<class Func>
@@ -244,9 +278,108 @@ template<class... Ts> class variant_ptr {
 };
 #endif
 
+namespace impl {
+template<class T> inline constexpr bool is_variant_ptr = false;
+template<class... Ts>
+inline constexpr bool is_variant_ptr<variant_ptr<Ts...>> = true;
+
+template<class T> concept VariantPtr = is_variant_ptr<T>;
+
+/**
+ * The jump table for visiting several variants at once. The variants' tags
+ * are flattened into one index (row major: the last variant's tag varies
+ * fastest), so N-ary dispatch is a single table lookup.
+ */
+template<class Func, class... Variants> struct multi_visit_table {
+  static constexpr std::size_t sizes[] = {Variants::size...};
+  static constexpr std::size_t count =
+      (std::size_t{1} * ... * Variants::size);
+
+ private:
+  using variant_tuple = std::tuple<Variants...>;
+  template<std::size_t j>
+  using nth_variant = std::tuple_element_t<j, variant_tuple>;
+
+  // how far apart consecutive tags of the jth variant are in the flat index
+  static constexpr std::size_t stride(std::size_t const j) noexcept {
+    std::size_t acc = 1;
+    for(auto i = j + 1; i < sizeof...(Variants); ++i) acc *= sizes[i];
+    return acc;
+  }
+  // the jth variant's tag for a given flat index
+  template<std::size_t flat, std::size_t j>
+  static constexpr std::size_t index_of = flat / stride(j) % sizes[j];
+
+  template<std::size_t flat, std::size_t... j>
+  static constexpr decltype(auto) invoke_flat(Func&               visitor,
+                                              variant_tuple const vs,
+                                              std::index_sequence<j...>) {
+    return std::invoke(visitor,
+                       nth_variant<j>::template get<index_of<flat, j>>(
+                           std::get<j>(vs))...);
+  }
+  template<std::size_t flat>
+  using result_at = decltype(invoke_flat<flat>(
+      std::declval<Func&>(),
+      std::declval<variant_tuple>(),
+      std::index_sequence_for<Variants...>{}));
+  template<std::size_t flat>
+  static constexpr bool is_noexcept_at = noexcept(invoke_flat<flat>(
+      std::declval<Func&>(),
+      std::declval<variant_tuple>(),
+      std::index_sequence_for<Variants...>{}));
+
+  template<class seq> struct by_seq;
+  template<std::size_t... flat> struct by_seq<std::index_sequence<flat...>> {
+    using common_type = std::common_type_t<result_at<flat>...>;
+    static constexpr bool is_noexcept =
+        impl::is_assert_off && (is_noexcept_at<flat> && ...);
+
+    template<class R, std::size_t n>
+    static constexpr R entry(Func& visitor, variant_tuple const vs) {
+      return invoke_flat<n>(visitor,
+                            vs,
+                            std::index_sequence_for<Variants...>{});
+    }
+    template<class R>
+    static constexpr R (*table[])(Func&, variant_tuple) = {&entry<R, flat>...};
+  };
+  using all = by_seq<std::make_index_sequence<count>>;
+
+ public:
+  using common_type                 = typename all::common_type;
+  static constexpr bool is_noexcept = all::is_noexcept;
+
+  template<class R>
+  static constexpr R visit(Func& visitor, Variants const... variants) {
+    std::size_t flat = 0;
+    ((flat = flat * Variants::size + Variants::index(variants)), ...);
+    BITPACK_ASSERT(flat < count);
+    return all::template table<R>[flat](visitor, variant_tuple{variants...});
+  }
+};
+} // namespace impl
+
+/**
+ * Visit several variant_ptrs at once, like std::visit. The visitor is called
+ * with the contents of every variant. The combined tag picks the entry in one
+ * jump table, so there's only one indirect jump no matter how many variants.
+ */
+template<class R, class Func, impl::VariantPtr... Variants>
+requires(sizeof...(Variants) >= 2) //
+    inline constexpr R visit(Func visitor, Variants const... variants) noexcept(
+        impl::multi_visit_table<Func, Variants...>::is_noexcept) {
+  return impl::multi_visit_table<Func, Variants...>::template visit<R>(
+      visitor, variants...);
+}
+template<class Func, impl::VariantPtr... Variants>
+requires(sizeof...(Variants) >= 2) //
+    inline constexpr auto visit(Func visitor, Variants const... variants)
+        BITPACK_EXPR_BODY(visit<typename impl::multi_visit_table<
+                              Func,
+                              Variants...>::common_type>(visitor, variants...))
+
 // possible future directions:
-// - derived_variant_ptr. Put the rtti into a tag
-// - unique_variant?
 // - variant_ptr etc that can hold pointer-like things?
 
 } // namespace bitpack
@@ -0,0 +1,7 @@
+// bitpack.hpp with BITPACK_ENABLE_ASSERT, so BITPACK_ASSERT is the standard
+// assert(). tester defines its own variadic BITPACK_ASSERT, which would let
+// through a condition that assert() can't take (say, a template argument
+// list's comma outside parentheses). This only has to compile.
+#include <bitpack/bitpack.hpp>
+
+static_assert(BITPACK_ENABLE_ASSERT);
@@ -34,6 +34,58 @@ TEST_CASE("The asserts are on") {
 #  define STATISH_REQUIRE REQUIRE
 #endif
 
+// the byte-at-a-time definitions that as_UInt/from_UInt's fast paths replace
+template<class UInt, std::endian endian, class T>
+UInt reference_as_UInt(T const x) {
+  auto const bytes = bitpack::bits::bytes_of(x);
+  UInt       acc{};
+  for(auto i = 0u; i < bytes.size(); ++i) {
+    auto const idx = endian == std::endian::little ? i : bytes.size() - i - 1;
+    acc |= static_cast<UInt>(bytes[idx]) << (i * CHAR_BIT);
+  }
+  return acc;
+}
+template<class To, std::endian endian, class From>
+To reference_from_UInt(From const from) {
+  std::array<std::byte, sizeof(To)> bytes;
+  for(auto i = 0u; i < bytes.size(); ++i) {
+    auto const idx = endian == std::endian::little ? i : bytes.size() - i - 1;
+    bytes[idx] = static_cast<std::byte>(from >> (i * CHAR_BIT));
+  }
+  return std::bit_cast<To>(bytes);
+}
+
+TEMPLATE_TEST_CASE("as_UInt and from_UInt match the byte-at-a-time reference "
+                   "in both byte orders",
+                   "",
+                   std::uint8_t,
+                   std::int16_t,
+                   std::int32_t,
+                   float,
+                   double) {
+  using namespace bitpack::bits;
+  using UInt = std::uint64_t;
+  for(int i = -100; i < 100; ++i) {
+    auto const x = static_cast<TestType>(i * 37);
+    REQUIRE(as_UInt<UInt, TestType, std::endian::little>(x)
+            == reference_as_UInt<UInt, std::endian::little>(x));
+    REQUIRE(as_UInt<UInt, TestType, std::endian::big>(x)
+            == reference_as_UInt<UInt, std::endian::big>(x));
+
+    auto const little = as_UInt<UInt, TestType, std::endian::little>(x);
+    auto const big    = as_UInt<UInt, TestType, std::endian::big>(x);
+    REQUIRE(from_UInt<TestType, UInt, std::endian::little>(little)
+            == reference_from_UInt<TestType, std::endian::little>(little));
+    REQUIRE(from_UInt<TestType, UInt, std::endian::big>(big)
+            == reference_from_UInt<TestType, std::endian::big>(big));
+    REQUIRE(from_UInt<TestType, UInt, std::endian::big>(big) == x);
+  }
+  STATISH_REQUIRE(as_UInt<std::uint32_t, std::uint32_t, std::endian::big>(
+                      0x11223344u)
+                  == (std::endian::native == std::endian::big ? 0x11223344u
+                                                              : 0x44332211u));
+}
+
 TEST_CASE("from_uintptr and as_uintptr are inverses") {
   int const x = 15124;
   using namespace bitpack::bits;
@@ -242,8 +294,10 @@ TEST_CASE("Niebloids give == values on bitpack containers and std "
                                     [](void*) { return "void*"s; },
                                     [](double*) { return "double*"s; }};
 
-      int x_ = 3;
-      var   = &x_;
+      // 5 alternatives need 3 tag bits, more than int's alignment leaves
+      // free, so this has to be explicit (and x_ has to be aligned for it)
+      alignas(8) int x_ = 3;
+      var               = decltype(var){&x_};
       REQUIRE(niebloids::visit(visitor, var) == "int*"s);
 
       var = static_cast<decltype(var)>(static_cast<void*>(&x_));
@@ -251,3 +305,1466 @@ TEST_CASE("Niebloids give == values on bitpack containers and std "
     }
   }
 }
+
+template<int I> struct alignas(32) alternative {
+  int value = I;
+};
+TEST_CASE("visit dispatches on the tag for variant_ptrs with many "
+          "alternatives") {
+  using Variant = decltype([]<int... I>(std::integer_sequence<int, I...>) {
+    return bitpack::variant_ptr<alternative<I>*...>{};
+  }(std::make_integer_sequence<int, 20>{}));
+  STATIC_REQUIRE(Variant::size == 20);
+
+  alternative<0>  a0;
+  alternative<7>  a7;
+  alternative<19> a19;
+  // visitors don't need to return a default constructible type
+  struct result {
+    int value;
+    explicit result(int v) : value{v} {}
+  };
+  auto const visitor = [](auto* alt) { return result{alt->value}; };
+
+  REQUIRE(bitpack::visit(visitor, Variant{&a0}).value == 0);
+  REQUIRE(bitpack::visit(visitor, Variant{&a7}).value == 7);
+  REQUIRE(bitpack::visit(visitor, Variant{&a19}).value == 19);
+  REQUIRE(niebloids::visit(visitor, Variant{&a19}).value == 19);
+}
+
+TEST_CASE("visit can take several variant_ptrs at once, like std::visit") {
+  using BpkVariant = bitpack::variant_ptr<int*, long*, double*>;
+  using StdVariant = std::variant<int*, long*, double*>;
+  auto const visitor =
+      overload{[](auto*, auto*) { return 0; },
+               [](int*, double*) { return 1; },
+               [](double*, int*) { return 2; },
+               [](long*, long*, auto*) { return 3; },
+               [](auto*, auto*, auto*) { return 4; }};
+
+  int    i = 0;
+  long   l = 0;
+  double d = 0;
+  REQUIRE(bitpack::visit(visitor, BpkVariant{&i}, BpkVariant{&d})
+          == std::visit(visitor, StdVariant{&i}, StdVariant{&d}));
+  REQUIRE(bitpack::visit(visitor, BpkVariant{&d}, BpkVariant{&i}) == 2);
+  REQUIRE(bitpack::visit(visitor, BpkVariant{&l}, BpkVariant{&i}) == 0);
+  REQUIRE(niebloids::visit(visitor, BpkVariant{&d}, BpkVariant{&i}) == 2);
+
+  SECTION("the variants can have different types") {
+    bitpack::variant_ptr<long*, int*> other = &l;
+    REQUIRE(bitpack::visit(visitor, BpkVariant{&l}, other, BpkVariant{&i})
+            == 3);
+    REQUIRE(bitpack::visit(visitor, other, BpkVariant{&l}, BpkVariant{&i})
+            == 3);
+    other = &i;
+    REQUIRE(bitpack::visit(visitor, other, BpkVariant{&l}, BpkVariant{&i})
+            == 4);
+  }
+  SECTION("with an explicit return type") {
+    REQUIRE(bitpack::visit<long>(visitor, BpkVariant{&i}, BpkVariant{&d})
+            == 1L);
+  }
+}
+
+// atomic tagged ptr
+TEST_CASE("atomic_tagged_ptr loads what was stored") {
+  using tagged = bitpack::tagged_ptr<int*, int>;
+  int                                   x = 1, y = 2;
+  bitpack::atomic_tagged_ptr<int*, int> p{tagged{&x, 1}};
+  REQUIRE(p.load().ptr() == &x);
+  REQUIRE(p.load().tag() == 1);
+
+  p.store(tagged{&y, 3});
+  REQUIRE(p.load().ptr() == &y);
+  REQUIRE(p.load().tag() == 3);
+
+  auto const old = p.exchange(tagged{&x, 2});
+  REQUIRE(old.ptr() == &y);
+  REQUIRE(old.tag() == 3);
+  REQUIRE(p.load().ptr() == &x);
+
+  STATIC_REQUIRE(decltype(p)::is_always_lock_free);
+}
+
+TEST_CASE("atomic_tagged_ptr compare_exchange compares the pointer and tag "
+          "together") {
+  using tagged = bitpack::tagged_ptr<int*, int>;
+  int                                   x = 1;
+  bitpack::atomic_tagged_ptr<int*, int> p{tagged{&x, 1}};
+
+  auto expected = tagged{&x, 2}; // same pointer, different tag
+  REQUIRE_FALSE(p.compare_exchange_strong(expected, tagged{nullptr, 0}));
+  REQUIRE(expected.tag() == 1); // failure loads the current value
+
+  REQUIRE(p.compare_exchange_strong(expected, tagged{nullptr, 3}));
+  REQUIRE(p.load() == nullptr);
+  REQUIRE(p.load().tag() == 3);
+}
+
+TEST_CASE("atomic_tagged_ptr fetch_set_tag and fetch_set_ptr replace one half "
+          "and keep the other") {
+  using tagged = bitpack::tagged_ptr<int*, int>;
+  int                                   x = 1, y = 2;
+  bitpack::atomic_tagged_ptr<int*, int> p{tagged{&x, 1}};
+
+  auto const old = p.fetch_set_tag(2);
+  REQUIRE(old.tag() == 1);
+  REQUIRE(p.load().ptr() == &x);
+  REQUIRE(p.load().tag() == 2);
+
+  p.fetch_set_ptr(&y);
+  REQUIRE(p.load().ptr() == &y);
+  REQUIRE(p.load().tag() == 2);
+}
+
+#include <thread>
+#include <vector>
+TEST_CASE("atomic_tagged_ptr's CAS doesn't lose concurrent updates") {
+  using tagged = bitpack::tagged_ptr<long*, unsigned>;
+  long                                        x = 0;
+  bitpack::atomic_tagged_ptr<long*, unsigned> p{tagged{&x, 0}};
+
+  constexpr int            thread_count = 4, increments = 1000;
+  std::vector<std::thread> threads;
+  for(int t = 0; t < thread_count; ++t)
+    threads.emplace_back([&] {
+      for(int i = 0; i < increments; ++i) {
+        auto old = p.load();
+        while(!p.compare_exchange_weak(old,
+                                       tagged{old.ptr(), (old.tag() + 1) % 8}))
+          ;
+      }
+    });
+  for(auto& t : threads) t.join();
+  REQUIRE(p.load().ptr() == &x);
+  REQUIRE(p.load().tag() == (thread_count * increments) % 8);
+}
+
+// atomic packed
+TEST_CASE("atomic_packed loads, stores and exchanges the whole pair") {
+  using counters =
+      bitpack::UInt_pair<std::uint32_t, std::uint32_t, std::uint64_t>;
+  bitpack::atomic_packed<counters> p{counters{1, 2}};
+  REQUIRE(p.load() == counters{1, 2});
+
+  p.store(counters{3, 4});
+  REQUIRE(p.load() == counters{3, 4});
+
+  REQUIRE(p.exchange(counters{5, 6}) == counters{3, 4});
+  REQUIRE(p.load() == counters{5, 6});
+
+  REQUIRE(bitpack::atomic_packed<counters>{}.load() == counters{0, 0});
+  STATIC_REQUIRE(decltype(p)::is_always_lock_free);
+}
+
+TEST_CASE("atomic_packed fetch_add and fetch_sub change one element") {
+  using counters =
+      bitpack::UInt_pair<std::uint32_t, std::uint16_t, std::uint64_t>;
+  bitpack::atomic_packed<counters> p{counters{10, 20}};
+
+  REQUIRE(p.fetch_add_x(5) == counters{10, 20});
+  REQUIRE(p.fetch_add_y(7) == counters{15, 20});
+  REQUIRE(p.load() == counters{15, 27});
+
+  REQUIRE(p.fetch_sub_x(15) == counters{15, 27});
+  REQUIRE(p.fetch_sub_y(1) == counters{0, 27});
+  REQUIRE(p.load() == counters{0, 26});
+
+  // filling an element up is fine, going past it isn't
+  p.fetch_add_y(0xFFFF - 26);
+  REQUIRE(p.load() == counters{0, 0xFFFF});
+  REQUIRE_THROWS(p.fetch_add_y(1)); // carried into x
+  REQUIRE_THROWS(p.fetch_sub_x(2)); // borrowed from the top of the word
+}
+
+TEST_CASE("atomic_packed checks for overflow in narrow elements") {
+  // 3 bits of y, the rest x
+  using counters =
+      bitpack::UInt_pair<std::uint16_t, std::uint8_t, std::uint16_t, 3>;
+  bitpack::atomic_packed<counters> p{counters{0, 6}};
+  p.fetch_add_y(1);
+  REQUIRE(p.load() == counters{0, 7});
+  REQUIRE_THROWS(p.fetch_add_y(1));
+
+  p.store(counters{(1 << 13) - 1, 0});
+  REQUIRE_THROWS(p.fetch_add_x(1));
+}
+
+TEST_CASE("atomic_packed compare_exchange and update") {
+  using counters =
+      bitpack::UInt_pair<std::uint32_t, std::int32_t, std::uint64_t>;
+  bitpack::atomic_packed<counters> p{counters{1, -1}};
+
+  auto expected = counters{1, 1};
+  REQUIRE_FALSE(p.compare_exchange_strong(expected, counters{0, 0}));
+  REQUIRE(expected == counters{1, -1}); // failure loads the current value
+  REQUIRE(p.compare_exchange_strong(expected, counters{2, -2}));
+  REQUIRE(p.load() == counters{2, -2});
+
+  auto const old =
+      p.update([](counters const c) { return counters{c.x() * 2, c.y() - 1}; });
+  REQUIRE(old == counters{2, -2});
+  REQUIRE(p.load() == counters{4, -3});
+}
+
+TEST_CASE("atomic_packed's fetch_adds don't lose concurrent updates") {
+  using counters =
+      bitpack::UInt_pair<std::uint32_t, std::uint32_t, std::uint64_t>;
+  bitpack::atomic_packed<counters> p;
+
+  constexpr int            thread_count = 4, increments = 1000;
+  std::vector<std::thread> threads;
+  for(int t = 0; t < thread_count; ++t)
+    threads.emplace_back([&] {
+      for(int i = 0; i < increments; ++i) {
+        p.fetch_add_x(1, std::memory_order_relaxed);
+        p.fetch_add_y(2, std::memory_order_relaxed);
+        p.update([](counters const c) { return counters{c.x() + 1, c.y()}; });
+      }
+    });
+  for(auto& t : threads) t.join();
+  REQUIRE(p.load() == counters{2 * thread_count * increments,
+                               2 * thread_count * increments});
+}
+
+TEST_CASE("high_tagged_ptr keeps 16 bits of tag beside any pointer") {
+  char c = 'a';
+  auto p = bitpack::high_tagged_ptr<char*, unsigned>{&c, 0xBEEF};
+  REQUIRE(p.ptr() == &c);
+  REQUIRE(p.tag() == 0xBEEF);
+  REQUIRE(*p == 'a');
+  STATIC_REQUIRE(sizeof(p) == sizeof(char*));
+
+  p = bitpack::high_tagged_ptr<char*, unsigned>{nullptr, 0xFFFF};
+  REQUIRE(p == nullptr);
+  REQUIRE(p.tag() == 0xFFFF);
+}
+
+TEST_CASE("high pointer tags restore canonical (sign extended) addresses") {
+  using storage = bitpack::tag_storage::high<16>;
+  uintptr_t const kernel_half = 0xFFFF'8000'0000'1000u;
+  uintptr_t const user_half   = 0x0000'7FFF'0000'1000u;
+  REQUIRE(storage::ptr(storage::pack(kernel_half, 0x1234)) == kernel_half);
+  REQUIRE(storage::ptr(storage::pack(user_half, 0x1234)) == user_half);
+  REQUIRE(storage::tag(storage::pack(kernel_half, 0x1234)) == 0x1234);
+}
+
+TEST_CASE("high_low_tagged_ptr uses both the high and low free bits") {
+  struct alignas(8) node {
+    int x;
+  } n{3};
+  using ptr = bitpack::high_low_tagged_ptr<node*, unsigned>;
+  STATIC_REQUIRE(ptr::tag_bits == 16 + 3);
+
+  auto const p = ptr{&n, (1u << 19) - 1};
+  REQUIRE(p.ptr() == &n);
+  REQUIRE(p.tag() == (1u << 19) - 1);
+  REQUIRE(p->x == 3);
+
+  auto const q = ptr{&n, 0b101};
+  REQUIRE(q.ptr() == &n);
+  REQUIRE(q.tag() == 0b101);
+}
+
+TEST_CASE("atomic_high_tagged_ptr CASes the high tag along with the pointer") {
+  using atomic = bitpack::atomic_high_tagged_ptr<char*, unsigned>;
+  using tagged = atomic::value_type;
+  char   c     = 'a';
+  atomic p{tagged{&c, 7}};
+  auto   expected = tagged{&c, 7};
+  REQUIRE(p.compare_exchange_strong(expected, tagged{&c, 8}));
+  REQUIRE(p.load().tag() == 8);
+  REQUIRE(p.load().ptr() == &c);
+}
+
+TEST_CASE("ordered_pair stores signed and floating point elements so the "
+          "packed word orders like the pair") {
+  using pair = bitpack::ordered_pair<int, short, std::uint64_t, 20>;
+  REQUIRE(pair{-3, -1}.x() == -3);
+  REQUIRE(pair{-3, -1}.y() == -1);
+  REQUIRE(pair{-3, -1}.word() < pair{-3, 0}.word());
+  REQUIRE(pair{-3, 5}.word() < pair{2, -7}.word());
+
+  using fpair = bitpack::ordered_pair<float, std::uint32_t, std::uint64_t>;
+  REQUIRE(fpair{-2.5f, 0}.x() == -2.5f);
+  REQUIRE(fpair{-2.5f, 0}.word() < fpair{-1.0f, 0}.word());
+  REQUIRE(fpair{-1.0f, 9}.word() < fpair{1.0f, 0}.word());
+  REQUIRE(fpair{-0.0f, 9}.word() < fpair{0.0f, 0}.word());
+}
+
+#include <limits>
+TEST_CASE("ordered_pair keeps NaNs, which are equal to themselves") {
+  using fpair    = bitpack::ordered_pair<float, std::uint32_t, std::uint64_t>;
+  auto const nan = std::numeric_limits<float>::quiet_NaN();
+  fpair const p{nan, 1};
+  REQUIRE(p.x() != p.x());
+  REQUIRE(p == fpair{nan, 1});
+  REQUIRE(fpair{1.0f, 1} < p);
+  REQUIRE(fpair{1.0f, 1}.with_x(nan) == p);
+}
+
+#include <random>
+TEST_CASE("UInt_pair comparisons agree with std::pair's when they compare the "
+          "packed word") {
+  std::mt19937                       gen{1234};
+  std::uniform_int_distribution<int> small{-4, 4};
+  for(int i = 0; i < 200; ++i) {
+    int const a = small(gen), b = small(gen), c = small(gen), d = small(gen);
+    using pair  = bitpack::ordered_pair<int, int, std::uint64_t>;
+    REQUIRE((pair{a, b} <=> pair{c, d})
+            == (std::pair{a, b} <=> std::pair{c, d}));
+    REQUIRE((pair{a, b} == pair{c, d})
+            == (std::pair{a, b} == std::pair{c, d}));
+
+    auto const ua = static_cast<unsigned>(a + 4);
+    auto const ub = static_cast<unsigned>(b + 4);
+    auto const uc = static_cast<unsigned>(c + 4);
+    auto const ud = static_cast<unsigned>(d + 4);
+    using upair   = bitpack::UInt_pair<unsigned, unsigned, std::uint64_t>;
+    REQUIRE((upair{ua, ub} <=> upair{uc, ud})
+            == (std::pair{ua, ub} <=> std::pair{uc, ud}));
+  }
+}
+
+#include <algorithm>
+TEST_CASE("radix_sort sorts ordered UInt_pairs like std::sort") {
+  using pair = bitpack::ordered_pair<int, short, std::uint64_t, 16>;
+  std::mt19937                       gen{99};
+  std::uniform_int_distribution<int> dist{-100000, 100000};
+  std::vector<pair>                  pairs;
+  for(int i = 0; i < 1000; ++i)
+    pairs.emplace_back(dist(gen), static_cast<short>(dist(gen) / 8));
+  auto expected = pairs;
+  std::ranges::sort(expected, [](pair a, pair b) {
+    return to_std_pair(a) < to_std_pair(b);
+  });
+
+  bitpack::radix_sort(std::span{pairs});
+  REQUIRE(pairs == expected);
+}
+
+TEST_CASE("radix_sort sorts tagged_ptrs by tag, then address") {
+  struct alignas(8) node {
+    int x;
+  };
+  std::vector<node> nodes(64);
+  SECTION("low tags") {
+    using ptr = bitpack::tagged_ptr<node*, unsigned>;
+    std::vector<ptr> ptrs;
+    for(unsigned i = 0; i < nodes.size(); ++i)
+      ptrs.emplace_back(&nodes[nodes.size() - 1 - i], i % 3);
+    bitpack::radix_sort(std::span{ptrs});
+    REQUIRE(std::ranges::is_sorted(ptrs, [](ptr a, ptr b) {
+      return std::pair{a.tag(), a.ptr()} < std::pair{b.tag(), b.ptr()};
+    }));
+  }
+  SECTION("high low tags") {
+    using ptr = bitpack::high_low_tagged_ptr<node*, unsigned>;
+    std::vector<ptr> ptrs;
+    for(unsigned i = 0; i < nodes.size(); ++i)
+      ptrs.emplace_back(&nodes[nodes.size() - 1 - i], (i * 37) % 1000);
+    bitpack::radix_sort(std::span{ptrs});
+    REQUIRE(std::ranges::is_sorted(ptrs, [](ptr a, ptr b) {
+      return std::pair{a.tag(), a.ptr()} < std::pair{b.tag(), b.ptr()};
+    }));
+  }
+  SECTION("variant_ptrs") {
+    using variant = bitpack::variant_ptr<node*, long*>;
+    long                 l[4];
+    std::vector<variant> vs{&nodes[3], &l[2], &nodes[1], &l[0], &nodes[2]};
+    bitpack::radix_sort(std::span{vs});
+    REQUIRE(std::ranges::is_sorted(vs, [](variant a, variant b) {
+      return std::pair{a.index(), a.word()} < std::pair{b.index(), b.word()};
+    }));
+    REQUIRE(vs[0].index() == 0);
+    REQUIRE(vs[4].index() == 1);
+  }
+}
+
+// packed vector
+TEST_CASE("packed_vector stores each element in exactly Bits bits") {
+  bitpack::packed_vector<std::uint16_t, 13> v;
+  for(std::uint16_t i = 0; i < 100; ++i) v.push_back(i * 81 % 8192);
+  REQUIRE(v.size() == 100);
+  REQUIRE(v.words().size() == (100 * 13 + 63) / 64);
+  for(std::uint16_t i = 0; i < 100; ++i) REQUIRE(v[i] == i * 81 % 8192);
+
+  SECTION("elements can be assigned through the proxy reference") {
+    v[4] = 8191; // straddles words 0 and 1 (bits 52-64)
+    v[5] = 0;
+    REQUIRE(v[3] == 3 * 81);
+    REQUIRE(v[4] == 8191);
+    REQUIRE(v[5] == 0);
+    REQUIRE(v[6] == 6 * 81);
+  }
+  SECTION("pop_back removes the last element") {
+    v.pop_back();
+    REQUIRE(v.size() == 99);
+    REQUIRE(v.back() == 98 * 81 % 8192);
+  }
+}
+
+TEST_CASE("packed_vector's iterators are random access") {
+  using vec = bitpack::packed_vector<unsigned, 5>;
+  STATIC_REQUIRE(std::random_access_iterator<vec::iterator>);
+  STATIC_REQUIRE(std::random_access_iterator<vec::const_iterator>);
+
+  vec v{3, 1, 4, 1, 5, 9, 2, 6};
+  REQUIRE(v.end() - v.begin() == 8);
+  REQUIRE(v.begin()[5] == 9u);
+  REQUIRE(*std::ranges::max_element(v) == 9u);
+  REQUIRE(std::ranges::count(v, 1u) == 2);
+
+  for(auto x : v) x = 31;
+  REQUIRE(std::ranges::all_of(std::as_const(v),
+                              [](unsigned x) { return x == 31; }));
+}
+
+TEST_CASE("packed_vector get_range decodes a range of elements") {
+  bitpack::packed_vector<int, 20, bitpack::bits::ordered_encoding> v;
+  for(int i = -50; i < 50; ++i) v.push_back(i * 1000);
+  std::vector<int> out(30);
+  v.get_range(10, out);
+  for(int i = 0; i < 30; ++i) REQUIRE(out[i] == (i + 10 - 50) * 1000);
+}
+
+TEST_CASE("packed_vector keeps NaNs") {
+  auto const nan = std::numeric_limits<float>::quiet_NaN();
+  bitpack::packed_vector<float, 32> v{1.0f, nan};
+  v.push_back(nan);
+  v[0] = nan;
+  for(float const x : v) REQUIRE(x != x);
+}
+
+TEST_CASE("unpack and pack convert between pairs and columns") {
+  using pair = bitpack::ordered_pair<int, std::uint16_t, std::uint64_t>;
+  std::vector<pair> pairs;
+  for(int i = 0; i < 1000; ++i)
+    pairs.emplace_back(i - 500, static_cast<std::uint16_t>(i * 7));
+
+  std::vector<int>           xs(pairs.size());
+  std::vector<std::uint16_t> ys(pairs.size());
+  bitpack::unpack(std::span{std::as_const(pairs)}, xs, ys);
+  for(std::size_t i = 0; i < pairs.size(); ++i) {
+    REQUIRE(xs[i] == pairs[i].x());
+    REQUIRE(ys[i] == pairs[i].y());
+  }
+
+  std::vector<pair> repacked(pairs.size());
+  bitpack::pack<pair>(xs, ys, repacked);
+  REQUIRE(repacked == pairs);
+}
+
+TEST_CASE("lockfree_stack is last in, first out") {
+  bitpack::lockfree_stack<std::string> stack;
+  REQUIRE(stack.empty());
+  REQUIRE(stack.pop() == std::nullopt);
+  stack.push("a");
+  stack.emplace(3, 'b');
+  REQUIRE(!stack.empty());
+  REQUIRE(stack.pop() == "bbb");
+  REQUIRE(stack.pop() == "a");
+  REQUIRE(stack.pop() == std::nullopt);
+
+  stack.push("left behind"); // the destructor cleans this up
+}
+
+TEST_CASE("lockfree_stack loses and duplicates nothing under contention") {
+  constexpr int                 threads = 4, per_thread = 20000;
+  bitpack::lockfree_stack<int>  stack;
+  std::vector<std::thread>      workers;
+  std::vector<std::vector<int>> popped(threads);
+  for(int t = 0; t < threads; ++t)
+    workers.emplace_back([&, t] {
+      // push and pop in small batches so nodes get popped, recycled and
+      // pushed again while other threads are mid-CAS (the ABA pattern)
+      for(int i = 0; i < per_thread; i += 4) {
+        for(int j = i; j < i + 4; ++j) stack.push(t * per_thread + j);
+        for(int j = 0; j < 3; ++j)
+          if(auto const x = stack.pop()) popped[t].push_back(*x);
+      }
+    });
+  for(auto& w : workers) w.join();
+  while(auto const x = stack.pop()) popped[0].push_back(*x);
+
+  std::vector<int> all;
+  for(auto const& p : popped) all.insert(all.end(), p.begin(), p.end());
+  std::ranges::sort(all);
+  REQUIRE(all.size() == threads * per_thread);
+  for(int i = 0; i < threads * per_thread; ++i) REQUIRE(all[i] == i);
+}
+
+TEST_CASE("lockfree_queue is first in, first out") {
+  bitpack::lockfree_queue<int> queue;
+  REQUIRE(queue.empty());
+  REQUIRE(queue.pop() == std::nullopt);
+  for(int i = 0; i < 10; ++i) queue.push(i);
+  REQUIRE(!queue.empty());
+  for(int i = 0; i < 5; ++i) REQUIRE(queue.pop() == i);
+  queue.push(10);
+  for(int i = 5; i < 11; ++i) REQUIRE(queue.pop() == i);
+  REQUIRE(queue.pop() == std::nullopt);
+}
+
+TEST_CASE("lockfree_queue keeps each producer's order under contention") {
+  constexpr int producers = 3, consumers = 3, per_thread = 20000;
+  bitpack::lockfree_queue<int>  queue;
+  std::atomic<int>              done{0};
+  std::vector<std::vector<int>> popped(consumers);
+  std::vector<std::thread>      threads;
+  for(int p = 0; p < producers; ++p)
+    threads.emplace_back([&, p] {
+      for(int i = 0; i < per_thread; ++i) queue.push(p * per_thread + i);
+      ++done;
+    });
+  for(int c = 0; c < consumers; ++c)
+    threads.emplace_back([&, c] {
+      while(true) {
+        bool const finished = done == producers;
+        if(auto const x = queue.pop())
+          popped[c].push_back(*x);
+        else if(finished)
+          break;
+      }
+    });
+  for(auto& t : threads) t.join();
+
+  std::vector<int> all;
+  for(auto const& values : popped) {
+    // each consumer sees each producer's values in the order they were pushed
+    std::array<int, producers> last;
+    last.fill(-1);
+    for(auto const x : values) {
+      REQUIRE(x > last[x / per_thread]);
+      last[x / per_thread] = x;
+    }
+    all.insert(all.end(), values.begin(), values.end());
+  }
+  std::ranges::sort(all);
+  REQUIRE(all.size() == producers * per_thread);
+  for(int i = 0; i < producers * per_thread; ++i) REQUIRE(all[i] == i);
+}
+
+TEST_CASE("lockfree_set keeps unique keys in order") {
+  bitpack::lockfree_set<int> set;
+  REQUIRE(set.empty());
+  REQUIRE(set.insert(3));
+  REQUIRE(set.insert(1));
+  REQUIRE(set.insert(2));
+  REQUIRE(!set.insert(2));
+  REQUIRE(set.contains(1));
+  REQUIRE(set.contains(3));
+  REQUIRE(!set.contains(4));
+
+  REQUIRE(set.erase(2));
+  REQUIRE(!set.erase(2));
+  REQUIRE(!set.contains(2));
+  REQUIRE(set.insert(2));
+  REQUIRE(set.contains(2));
+
+  bitpack::lockfree_set<int, std::greater<>> descending;
+  for(int i = 0; i < 10; ++i) REQUIRE(descending.insert(i));
+  for(int i = 0; i < 10; ++i) REQUIRE(descending.contains(i));
+}
+
+TEMPLATE_TEST_CASE("lockfree_set agrees with a sequential set under "
+                   "contention",
+                   "",
+                   bitpack::reclaim_on_destruction,
+                   bitpack::epoch_reclaimer,
+                   bitpack::hazard_reclaimer) {
+  constexpr int threads = 4, keys = 64, ops = 20000;
+  bitpack::lockfree_set<int, std::less<>, TestType> set;
+  // each thread owns the keys k with k % threads == t, so it can check
+  // every result against its own sequential model, while the others change
+  // the nodes around its keys
+  std::vector<std::thread> workers;
+  std::atomic<bool>        ok{true};
+  for(int t = 0; t < threads; ++t)
+    workers.emplace_back([&, t] {
+      std::mt19937           gen(t);
+      std::array<bool, keys> model{};
+      for(int i = 0; i < ops; ++i) {
+        int const k = static_cast<int>(gen() % (keys / threads)) * threads + t;
+        bool const had = model[k];
+        switch(gen() % 3) {
+          case 0:
+            ok       = ok && set.insert(k) == !had;
+            model[k] = true;
+            break;
+          case 1:
+            ok       = ok && set.erase(k) == had;
+            model[k] = false;
+            break;
+          default: ok = ok && set.contains(k) == had; break;
+        }
+      }
+    });
+  for(auto& w : workers) w.join();
+  REQUIRE(ok);
+}
+
+// counts live instances, to see when reclaimers free things
+struct alignas(8) counted {
+  static inline std::atomic<int> alive{0};
+  bool*                          destroyed = nullptr;
+  counted() { ++alive; }
+  explicit counted(bool* const destroyed) : counted{} {
+    this->destroyed = destroyed;
+  }
+  ~counted() {
+    --alive;
+    if(destroyed != nullptr) *destroyed = true;
+  }
+};
+
+TEST_CASE("epoch_domain frees retired objects once no guard can see them") {
+  REQUIRE(counted::alive == 0);
+  {
+    bitpack::epoch_domain domain;
+    {
+      auto const guard = domain.pin();
+      for(int i = 0; i < 1000; ++i) domain.retire(new counted);
+      // the guard holds the epoch back, so nothing can be freed yet
+      REQUIRE(domain.epoch() <= 1);
+      REQUIRE(counted::alive == 1000);
+    }
+    for(int i = 0; i < 1000; ++i) domain.retire(new counted);
+    REQUIRE(domain.epoch() >= 2);
+    REQUIRE(counted::alive < 1000);
+  }
+  REQUIRE(counted::alive == 0);
+}
+
+TEST_CASE("Reclaimers strip tags before freeing tagged_ptrs and variant_ptrs") {
+  using tagged  = bitpack::high_tagged_ptr<counted*, unsigned>;
+  using variant = bitpack::variant_ptr<int*, counted*>;
+  {
+    bitpack::epoch_domain domain;
+    domain.retire(tagged{new counted, 0xBEEF});
+    domain.retire(variant{new counted});
+    bitpack::reclaim_on_destruction on_destruction;
+    on_destruction.retire(tagged{new counted, 0xBEEF});
+    on_destruction.retire(variant{new counted});
+    REQUIRE(counted::alive == 4);
+  }
+  REQUIRE(counted::alive == 0);
+}
+
+TEST_CASE("hazard_domain doesn't free objects a hazard pointer holds") {
+  using tagged = bitpack::high_tagged_ptr<counted*, unsigned>;
+  bool destroyed = false;
+  {
+    bitpack::hazard_domain                              domain;
+    bitpack::atomic_high_tagged_ptr<counted*, unsigned> shared{
+        tagged{new counted{&destroyed}, 0xBEEF}};
+    {
+      auto       guard = domain.pin();
+      auto const seen  = guard.protect(0, shared);
+      REQUIRE(seen.tag() == 0xBEEF);
+      shared.store(tagged{nullptr, 0});
+      domain.retire(seen);
+      // enough to scan a few times
+      for(int i = 0; i < 200; ++i) domain.retire(new counted);
+      REQUIRE(!destroyed);
+      REQUIRE(counted::alive < 200);
+    }
+    for(int i = 0; i < 200; ++i) domain.retire(new counted);
+    REQUIRE(destroyed);
+  }
+  REQUIRE(counted::alive == 0);
+}
+
+TEST_CASE("slot_map handles go stale when their element is erased") {
+  bitpack::slot_map<std::string> map;
+  auto const a = map.insert("a");
+  auto const b = map.insert("b");
+  auto const c = map.emplace(3, 'c');
+  REQUIRE(map.size() == 3);
+  REQUIRE(map[a] == "a");
+  REQUIRE(map[c] == "ccc");
+  STATIC_REQUIRE(sizeof(a) == sizeof(std::uint64_t));
+
+  REQUIRE(map.erase(a));
+  REQUIRE(!map.erase(a));
+  REQUIRE(!map.contains(a));
+  REQUIRE(map.find(a) == nullptr);
+  REQUIRE(map[b] == "b");
+  REQUIRE(map[c] == "ccc");
+
+  // the slot is reused, but under a new generation
+  auto const d = map.insert("d");
+  REQUIRE(d.x() == a.x());
+  REQUIRE(d.y() != a.y());
+  REQUIRE(!map.contains(a));
+  REQUIRE(*map.find(d) == "d");
+
+  // the elements are stored densely
+  REQUIRE(map.values().size() == 3);
+  for(std::size_t i = 0; i < map.size(); ++i)
+    REQUIRE(&map[map.handle_at(i)] == &map.values()[i]);
+
+  map.clear();
+  REQUIRE(map.empty());
+  REQUIRE(!map.contains(b));
+  REQUIRE(!map.contains(d));
+}
+
+TEST_CASE("slot_map generations wrap around in generation_bits") {
+  bitpack::slot_map<int, 2> map;
+  auto const first = map.insert(0);
+  auto       h     = first;
+  for(int i = 0; i < 4; ++i) {
+    map.erase(h);
+    h = map.insert(i);
+  }
+  REQUIRE(h.x() == first.x());
+  REQUIRE(h.y() == first.y()); // 2 bits of generation: 4 reuses come back
+}
+
+TEST_CASE("slot_map handles can be a 32 bit word split 24/8") {
+  bitpack::slot_map<int, 8, std::uint32_t> map;
+  STATIC_REQUIRE(sizeof(decltype(map)::handle) == sizeof(std::uint32_t));
+  STATIC_REQUIRE(decltype(map)::max_slots == std::size_t{1} << 24);
+
+  auto const a = map.insert(1);
+  auto const b = map.insert(2);
+  REQUIRE(map[a] == 1);
+  REQUIRE(map[b] == 2);
+  REQUIRE(map.erase(a));
+  REQUIRE(!map.contains(a));
+  REQUIRE(map[b] == 2);
+
+  // 8 bits of generation: the slot comes back around after 256 reuses
+  auto h = map.insert(3);
+  REQUIRE(h.x() == a.x());
+  for(int i = 1; i < 255; ++i) {
+    REQUIRE(h.y() != a.y());
+    map.erase(h);
+    h = map.insert(i);
+  }
+  REQUIRE(h.y() != a.y());
+  map.erase(h);
+  h = map.insert(4);
+  REQUIRE(h.x() == a.x());
+  REQUIRE(h.y() == a.y());
+  REQUIRE(map[h] == 4);
+  REQUIRE(map[b] == 2);
+}
+
+TEST_CASE("slot_map stops at max_slots") {
+  // 16 bit handles, 4 bits of index
+  using map_type = bitpack::slot_map<int, 12, std::uint16_t, std::uint16_t>;
+  STATIC_REQUIRE(map_type::max_slots == 16);
+  map_type map;
+  std::vector<map_type::handle> handles;
+  for(int i = 0; i < 16; ++i)
+    handles.push_back(map.insert(i));
+  REQUIRE_THROWS_AS(map.insert(16), std::length_error);
+  REQUIRE(map.size() == 16);
+
+  // freed slots can still be reused
+  REQUIRE(map.erase(handles[5]));
+  auto const h = map.insert(16);
+  REQUIRE(h.x() == handles[5].x());
+  for(int i = 0; i < 16; ++i)
+    if(i != 5)
+      REQUIRE(map[handles[i]] == i);
+  REQUIRE(map[h] == 16);
+}
+
+namespace {
+// 64 KiB to point into, as a compressed pointer OffsetBase
+struct test_arena {
+  static std::byte* base() noexcept {
+    alignas(64) static std::byte memory[1 << 16];
+    return memory;
+  }
+};
+template<class T> T* arena_at(std::size_t const offset) {
+  return ::new(test_arena::base() + offset) T{};
+}
+} // namespace
+
+TEST_CASE("compressed_ptr stores an arena offset in 32 bits") {
+  using ptr = bitpack::compressed_ptr<std::uint64_t, test_arena>;
+  STATIC_REQUIRE(sizeof(ptr) == sizeof(std::uint32_t));
+  STATIC_REQUIRE(ptr::reach() == ((std::uint64_t{1} << 32) - 1) * 8);
+
+  auto* const first = arena_at<std::uint64_t>(0);
+  auto* const other = arena_at<std::uint64_t>(800);
+  ptr const   a     = first;
+  ptr const   b     = other;
+  REQUIRE(a.get() == first);
+  REQUIRE(b.get() == other);
+  REQUIRE(b.word() == 800 / 8 + 1); // scaled by alignment, 0 is null
+  *b = 42;
+  REQUIRE(*other == 42);
+  REQUIRE(a != b);
+  REQUIRE(a == ptr{first});
+
+  ptr const null = nullptr;
+  REQUIRE(null == nullptr);
+  REQUIRE(!null);
+  REQUIRE(a != nullptr); // the arena's first object isn't null
+  REQUIRE(static_cast<bool>(a));
+  REQUIRE(ptr::from_word(b.word()).get() == other);
+
+  // nodes can link to their own (incomplete) type
+  struct node {
+    bitpack::compressed_ptr<node, test_arena> next;
+  };
+  STATIC_REQUIRE(sizeof(node) == sizeof(std::uint32_t));
+  auto* const n = arena_at<node>(64);
+  n->next       = n;
+  REQUIRE(n->next->next.get() == n);
+}
+
+TEST_CASE("compressed_variant_ptr works like variant_ptr in 32 bits") {
+  using variant = bitpack::compressed_variant_ptr<test_arena,
+                                                  char*,
+                                                  std::uint16_t*,
+                                                  double*>;
+  STATIC_REQUIRE(sizeof(variant) == sizeof(std::uint32_t));
+  STATIC_REQUIRE(variant::tag_bits == 2);
+  // scaled by char's alignment (1), with 2 bits for the tag
+  STATIC_REQUIRE(variant::reach() == (std::uint64_t{1} << 30) - 1);
+
+  // no alignment bits needed for the tag
+  auto* const c = arena_at<char>(1001);
+  auto* const d = arena_at<double>(2048);
+  variant     v = c;
+  REQUIRE(v.index() == 0);
+  REQUIRE(bitpack::get<char*>(v) == c);
+  REQUIRE(bitpack::holds_alternative<char*>(v));
+  REQUIRE(!bitpack::holds_alternative<double*>(v));
+  REQUIRE(bitpack::maybe_get<double*>(v) == std::nullopt);
+
+  v = d;
+  REQUIRE(v.index() == 2);
+  REQUIRE(bitpack::get<2>(v) == d);
+  auto const which = overload{[](char*) { return 'c'; },
+                              [](std::uint16_t*) { return 'u'; },
+                              [](double*) { return 'd'; }};
+  REQUIRE(bitpack::visit(which, v) == 'd');
+
+  // visit several at once, mixed with a plain variant_ptr
+  long                              l;
+  bitpack::variant_ptr<long*, int*> plain = &l;
+  auto const sizes = [](auto const x, auto const y) {
+    return sizeof(*x) + sizeof(*y);
+  };
+  REQUIRE(bitpack::visit(sizes, v, plain) == sizeof(double) + sizeof(long));
+
+  variant const null = static_cast<std::uint16_t*>(nullptr);
+  REQUIRE(null == nullptr);
+  REQUIRE(null.index() == 1);
+  REQUIRE(v != nullptr);
+}
+
+TEST_CASE("arena aligns every allocation to its minimum alignment") {
+  bitpack::arena<16> arena{256};
+  STATIC_REQUIRE(bitpack::arena<16>::tag_bits == 4);
+  STATIC_REQUIRE(
+      !std::is_convertible_v<char*, bitpack::variant_ptr<char*, int*>>);
+  auto const address = [](void const* p) {
+    return bitpack::bits::bit_cast<std::uintptr_t>(p);
+  };
+
+  std::vector<char*> chars;
+  for(int i = 0; i < 100; ++i) chars.push_back(arena.make<char>('a' + i % 26));
+  for(int i = 0; i < 100; ++i) {
+    REQUIRE(address(chars[i]) % 16 == 0);
+    REQUIRE(*chars[i] == 'a' + i % 26); // nothing overlaps
+  }
+  REQUIRE(arena.capacity() > 256); // it took more chunks
+
+  // over-aligned requests, and ones bigger than a chunk
+  REQUIRE(address(arena.allocate(1, 4096)) % 4096 == 0);
+  auto* const big = static_cast<std::byte*>(arena.allocate(10'000));
+  std::fill(big, big + 10'000, std::byte{1});
+  REQUIRE(*chars.back() == 'a' + 99 % 26);
+
+  // so a char has room for a 4 bit tag
+  using tagged = bitpack::tagged_ptr<char*, unsigned, 4>;
+  tagged const t{chars[0], 15u};
+  REQUIRE(t.ptr() == chars[0]);
+  REQUIRE(t.tag() == 15);
+  bitpack::variant_ptr<char*, short*, int*> const v{chars[1]};
+  REQUIRE(bitpack::get<char*>(v) == chars[1]);
+}
+
+TEST_CASE("arena reset frees everything but keeps the chunks") {
+  for(auto const pages : {bitpack::arena_pages::normal,
+                          bitpack::arena_pages::huge}) {
+    bitpack::arena<> arena{1024, pages};
+    REQUIRE(arena.capacity() == 0);
+    // the first allocation in the newest (biggest) chunk
+    std::uint64_t* newest_first = nullptr;
+    for(std::uint64_t i = 0; i < 1000; ++i) {
+      auto const  old_capacity = arena.capacity();
+      auto* const x            = arena.make<std::uint64_t>(i);
+      if(arena.capacity() != old_capacity) newest_first = x;
+    }
+    auto const capacity = arena.capacity();
+    REQUIRE(capacity >= 8000);
+
+    arena.reset();
+    REQUIRE(arena.capacity() == capacity);
+    // the memory is reused, biggest chunk first
+    REQUIRE(arena.make<std::uint64_t>(0) == newest_first);
+    for(std::uint64_t i = 1; i < 1000; ++i)
+      REQUIRE(*arena.make<std::uint64_t>(i) == i);
+    REQUIRE(arena.capacity() == capacity); // no new chunks
+
+    arena.release();
+    REQUIRE(arena.capacity() == 0);
+    REQUIRE(*arena.make<int>(3) == 3);
+  }
+}
+
+TEST_CASE("arena_resource lets pmr containers allocate from an arena") {
+  bitpack::arena<64>          arena;
+  bitpack::arena_resource<64> resource{arena};
+  std::pmr::vector<int>       xs{&resource};
+  for(int i = 0; i < 1000; ++i) xs.push_back(i);
+  REQUIRE(xs[999] == 999);
+  REQUIRE(bitpack::bits::bit_cast<std::uintptr_t>(xs.data()) % 64 == 0);
+
+  bitpack::arena_resource<64> same{arena};
+  REQUIRE(resource.is_equal(same));
+  REQUIRE(!resource.is_equal(*std::pmr::new_delete_resource()));
+}
+
+namespace ast {
+struct alignas(8) node {
+  int line = 0;
+};
+struct expr : node {};
+struct number : expr {
+  double value = 0;
+};
+struct add : expr {
+  node* lhs = nullptr;
+  node* rhs = nullptr;
+};
+struct mixin {
+  int extra = 7;
+};
+// node isn't the first base, so node* and print* are different addresses
+struct print : mixin, node {
+  node* arg = nullptr;
+};
+using ptr = bitpack::derived_variant_ptr<node, number, add, print>;
+} // namespace ast
+
+TEST_CASE("derived_variant_ptr visits the concrete class") {
+  ast::number n;
+  n.value = 2;
+  ast::print p;
+  p.arg = &n;
+  ast::ptr v{&n};
+  STATIC_REQUIRE(sizeof(v) == sizeof(void*));
+  REQUIRE(v.index() == 0);
+  REQUIRE(v.base() == &n);
+  REQUIRE(bitpack::get<ast::number>(v) == &n);
+
+  using namespace std::literals;
+  auto const name = overload{[](ast::number*) { return "number"s; },
+                             [](ast::add*) { return "add"s; },
+                             [](ast::print* p) {
+                               return "print " + std::to_string(p->extra);
+                             }};
+  REQUIRE(bitpack::visit(name, v) == "number");
+  v = ast::ptr{&p};
+  REQUIRE(static_cast<void*>(v.base()) != static_cast<void*>(&p));
+  REQUIRE(bitpack::get<2>(v) == &p);
+  REQUIRE(bitpack::visit(name, v) == "print 7");
+  REQUIRE(bitpack::holds_alternative<ast::print>(v));
+  REQUIRE(bitpack::maybe_get<ast::add>(v) == std::nullopt);
+}
+
+TEST_CASE("derived_variant_ptr::is and as work like dynamic_cast") {
+  ast::number n;
+  ast::add    a;
+  ast::print  p;
+  ast::ptr    num{&n}, sum{&a}, out{&p};
+
+  REQUIRE(num.is<ast::number>());
+  REQUIRE(num.is<ast::expr>()); // not an alternative, but a base of one
+  REQUIRE(num.is<ast::node>());
+  REQUIRE(!num.is<ast::add>());
+  REQUIRE(sum.is<ast::expr>());
+  REQUIRE(!out.is<ast::expr>());
+  REQUIRE(out.is<ast::mixin>());
+  REQUIRE(!num.is<std::string>());
+
+  REQUIRE(sum.as<ast::expr>() == static_cast<ast::expr*>(&a));
+  REQUIRE(out.as<ast::expr>() == nullptr);
+  REQUIRE(out.as<ast::print>() == &p);
+  REQUIRE(out.as<ast::mixin>() == static_cast<ast::mixin*>(&p));
+  REQUIRE(out.as<ast::mixin>()->extra == 7);
+
+  ast::ptr const null{static_cast<ast::add*>(nullptr)};
+  REQUIRE(null == nullptr);
+  REQUIRE(!null);
+  REQUIRE(num);
+  REQUIRE(!null.is<ast::add>()); // like dynamic_cast, null is nothing
+  REQUIRE(null.as<ast::expr>() == nullptr);
+}
+
+namespace owned {
+int destroyed = 0;
+struct leaf {
+  int value = 0;
+  ~leaf() { ++destroyed; }
+};
+struct branch;
+using child = bitpack::unique_variant_ptr<leaf*, branch*>;
+struct branch {
+  child lhs, rhs;
+  ~branch() { ++destroyed; }
+};
+// as if the ints came from a pool
+int freed_ints = 0;
+struct free_int {
+  void operator()(int* const p) const noexcept {
+    ++freed_ints;
+    delete p;
+  }
+};
+} // namespace owned
+
+TEST_CASE("unique_variant_ptr destroys through the tag") {
+  using namespace owned;
+  destroyed = 0;
+  {
+    auto tree = child::make<branch>();
+    STATIC_REQUIRE(sizeof(tree) == sizeof(void*));
+    auto* const b = bitpack::get<branch*>(tree.get());
+    b->lhs        = child::make<leaf>(1);
+    b->rhs        = child::make<branch>();
+    bitpack::get<branch*>(b->rhs.get())->lhs = child::make<leaf>(2);
+    REQUIRE(tree.holds_alternative<branch*>());
+    REQUIRE(b->lhs.index() == 0);
+    REQUIRE(bitpack::get<leaf*>(b->lhs.get())->value == 1);
+    REQUIRE(!bitpack::get<branch*>(b->rhs.get())->rhs);
+  }
+  REQUIRE(destroyed == 4);
+
+  destroyed = 0;
+  child a{new leaf{}};
+  child b = std::move(a);
+  REQUIRE(a == nullptr);
+  REQUIRE(b);
+  a = std::move(b);
+  REQUIRE(destroyed == 0);
+  a.reset();
+  REQUIRE(destroyed == 1);
+  REQUIRE(!a);
+
+  auto* const l = new leaf{};
+  a.reset(child::view{l});
+  auto const released = a.release();
+  REQUIRE(a == nullptr);
+  REQUIRE(bitpack::get<leaf*>(released) == l);
+  REQUIRE(destroyed == 1);
+  delete l;
+}
+
+TEST_CASE("unique_variant_ptr uses each alternative's deleter") {
+  using namespace owned;
+  destroyed  = 0;
+  freed_ints = 0;
+  {
+    bitpack::unique_variant_ptr<leaf*, bitpack::deleted_by<int*, free_int>>
+        p{new int{3}};
+    REQUIRE(p.index() == 1);
+    REQUIRE(*bitpack::get<int*>(p.get()) == 3);
+    p = decltype(p){new leaf{}};
+    REQUIRE(freed_ints == 1);
+    REQUIRE(destroyed == 0);
+  }
+  REQUIRE(destroyed == 1);
+  REQUIRE(freed_ints == 1);
+}
+
+#include <cmath>
+#include <limits>
+
+TEST_CASE("nan_box holds doubles and boxes the rest in NaNs") {
+  int  x = 5;
+  char c = 'c';
+  using box = bitpack::nan_box<int*, char*>;
+  STATIC_REQUIRE(sizeof(box) == 8);
+  STATIC_REQUIRE(box::size == 6);
+
+  box v = 1.5;
+  REQUIRE(v.index() == 0);
+  REQUIRE(bitpack::get<double>(v) == 1.5);
+  v = -std::numeric_limits<double>::infinity();
+  REQUIRE(bitpack::get<0>(v) == -std::numeric_limits<double>::infinity());
+  v = nullptr;
+  REQUIRE(bitpack::holds_alternative<std::nullptr_t>(v));
+  v = true;
+  REQUIRE(bitpack::get<bool>(v));
+  v = false;
+  REQUIRE(!bitpack::get<bool>(v));
+  v = std::int32_t{-7};
+  REQUIRE(v.index() == 3);
+  REQUIRE(bitpack::get<std::int32_t>(v) == -7);
+  v = &x;
+  REQUIRE(bitpack::get<int*>(v) == &x);
+  v = &c;
+  REQUIRE(bitpack::get<5>(v) == &c);
+  REQUIRE(bitpack::maybe_get<int*>(v) == std::nullopt);
+
+  auto const kind = overload{[](double) { return 0; },
+                             [](std::nullptr_t) { return 1; },
+                             [](bool) { return 2; },
+                             [](std::int32_t) { return 3; },
+                             [](int* p) { return *p; },
+                             [](char* p) { return int{*p}; }};
+  REQUIRE(bitpack::visit(kind, box{2.0}) == 0);
+  REQUIRE(bitpack::visit(kind, box{true}) == 2);
+  REQUIRE(bitpack::visit(kind, box{&x}) == 5);
+  REQUIRE(bitpack::visit(kind, v) == 'c');
+  // mixed with a variant_ptr
+  auto const sum = overload{[](std::int32_t i, int* p) { return i + *p; },
+                            [](auto, auto) { return -1; }};
+  REQUIRE(bitpack::visit(sum, box{1}, bitpack::variant_ptr<int*>{&x}) == 6);
+}
+
+TEST_CASE("nan_box canonicalizes NaNs") {
+  using box        = bitpack::nan_box<int*>;
+  auto const quiet = std::numeric_limits<double>::quiet_NaN();
+  // a negative NaN with a payload: the bits of a boxed value
+  auto const odd =
+      bitpack::bits::bit_cast<double>(std::uint64_t{0xFFFD'0000'0000'0001});
+  REQUIRE(odd != odd);
+  box const a{odd}, b{-quiet}, c{std::numeric_limits<double>::signaling_NaN()};
+  REQUIRE(a.index() == 0);
+  REQUIRE(identical(a, b));
+  REQUIRE(identical(b, c));
+  REQUIRE(std::isnan(bitpack::get<double>(a)));
+  REQUIRE(!identical(box{0.0}, box{-0.0}));
+  REQUIRE(box::from_word(box{3}.word()).index() == 3);
+}
+
+namespace record {
+enum class color : std::uint8_t { red, green, blue };
+using bitpack::field;
+using packed = bitpack::packed_struct<
+    std::uint64_t,
+    field<bool, 1>,
+    field<color, 2>,
+    field<std::uint16_t, 12>, // an offset
+    field<std::uint32_t, 20>, // an id
+    field<std::int8_t, 5, bitpack::bits::ordered_encoding>>;
+} // namespace record
+
+TEST_CASE("packed_struct packs fields from the high bits down") {
+  using record::color;
+  record::packed const r{true, color::blue, 0xABC, 0x12345, -3};
+  STATIC_REQUIRE(sizeof(r) == 8);
+  STATIC_REQUIRE(record::packed::used_bits == 40);
+  STATIC_REQUIRE(std::tuple_size_v<record::packed> == 5);
+  STATIC_REQUIRE(
+      std::is_same_v<std::tuple_element_t<1, record::packed>, color>);
+  // layout: the first field is the highest
+  REQUIRE(r.word() >> 39 == 1);
+  REQUIRE((r.word() >> 25 & 0xFFF) == 0xABC);
+  REQUIRE((r.word() >> 5 & 0xFFFFF) == 0x12345);
+
+  REQUIRE(bitpack::get<0>(r));
+  REQUIRE(bitpack::get<color>(r) == color::blue);
+  REQUIRE(bitpack::get<2>(r) == 0xABC);
+  REQUIRE(bitpack::get<std::uint32_t>(r) == 0x12345);
+  REQUIRE(bitpack::get<std::int8_t>(r) == -3);
+
+  auto const [flag, c, offset, id, delta] = r;
+  REQUIRE(flag);
+  REQUIRE(c == color::blue);
+  REQUIRE(offset == 0xABC);
+  REQUIRE(id == 0x12345);
+  REQUIRE(delta == -3);
+  REQUIRE(to_tuple(r) == std::tuple{true, color::blue, 0xABC, 0x12345, -3});
+  REQUIRE(record::packed::from_word(r.word()) == r);
+}
+
+TEST_CASE("packed_struct compares like its fields") {
+  using ordered = record::packed;
+  STATIC_REQUIRE(ordered::is_word_ordered);
+  using record::color;
+  REQUIRE(ordered{false, color::red, 1, 1, -1}
+          < ordered{false, color::red, 1, 1, 0});
+  REQUIRE(ordered{false, color::blue, 1, 1, 0}
+          < ordered{true, color::red, 0, 0, 0});
+  REQUIRE(ordered{true, color::red, 5, 1, 0}
+          > ordered{true, color::red, 4, 9, 9});
+
+  // raw signed fields don't order by their bits, so compare field by field
+  using raw = bitpack::packed_struct<std::uint32_t,
+                                     bitpack::field<std::int16_t>,
+                                     bitpack::field<std::uint8_t>>;
+  STATIC_REQUIRE(!raw::is_word_ordered);
+  STATIC_REQUIRE(raw::is_word_equality);
+  REQUIRE(raw{-1, 0} < raw{1, 0});
+  REQUIRE(raw{-1, 7} == raw{-1, 7});
+  REQUIRE(raw{-1, 7} != raw{-1, 8});
+}
+
+TEST_CASE("packed_struct keeps NaNs in ordered fields") {
+  using bitpack::field;
+  using record = bitpack::packed_struct<
+      std::uint64_t,
+      field<float, 32, bitpack::bits::ordered_encoding>,
+      field<std::uint32_t>>;
+  auto const   nan = std::numeric_limits<float>::quiet_NaN();
+  record const r{nan, 1};
+  REQUIRE(r.get<0>() != r.get<0>());
+  REQUIRE(r.get<1>() == 1);
+  REQUIRE(r == record{nan, 1});
+}
+
+TEST_CASE("UInt_pair::with_x and with_y replace one element") {
+  using pair = bitpack::UInt_pair<unsigned, unsigned, std::uint32_t, 12>;
+  pair const p{0xABCDE, 0x123};
+  REQUIRE(p.with_x(7).x() == 7);
+  REQUIRE(p.with_x(7).y() == 0x123);
+  REQUIRE(p.with_y(0xFFF).x() == 0xABCDE);
+  REQUIRE(p.with_y(0xFFF).y() == 0xFFF);
+  REQUIRE(p.with_x(1).with_y(2) == pair{1, 2});
+
+  using opair = bitpack::ordered_pair<int, float, std::uint64_t>;
+  opair const q{-5, 0.25f};
+  REQUIRE(q.with_x(3) == opair{3, 0.25f});
+  REQUIRE(q.with_y(-1.5f) == opair{-5, -1.5f});
+}
+
+TEST_CASE("tagged_ptr::set_tag and set_ptr replace one half") {
+  alignas(8) int x = 0, y = 0;
+  bitpack::tagged_ptr<int*, unsigned, 3> p{&x, 5};
+  STATIC_REQUIRE(decltype(p)::tag_mask == 7);
+  p.set_tag(2);
+  REQUIRE(p.ptr() == &x);
+  REQUIRE(p.tag() == 2);
+  p.set_ptr(&y);
+  REQUIRE(p.ptr() == &y);
+  REQUIRE(p.tag() == 2);
+  REQUIRE(p.with_tag(7).with_ptr(&x).word()
+          == decltype(p){&x, 7}.word());
+
+  char c = 'c';
+  auto h = bitpack::high_tagged_ptr<char*, unsigned>{&c, 0xBEEF};
+  h.set_tag(0xFFFF);
+  REQUIRE(h.ptr() == &c);
+  REQUIRE(h.tag() == 0xFFFF);
+  h.set_ptr(nullptr);
+  REQUIRE(h == nullptr);
+  REQUIRE(h.tag() == 0xFFFF);
+
+  struct alignas(4) node {};
+  node n, m;
+  auto hl = bitpack::high_low_tagged_ptr<node*, unsigned>{&n, 0x3FFFF};
+  hl.set_tag(0x2A5A5);
+  REQUIRE(hl.ptr() == &n);
+  REQUIRE(hl.tag() == 0x2A5A5);
+  hl.set_ptr(&m);
+  REQUIRE(hl.ptr() == &m);
+  REQUIRE(hl.tag() == 0x2A5A5);
+}
+
+TEST_CASE("set_xs, set_ys and set_tags update whole spans") {
+  using pair = bitpack::UInt_pair<unsigned, unsigned, std::uint32_t, 12>;
+  std::vector<pair> pairs;
+  for(unsigned i = 0; i < 100; ++i) pairs.emplace_back(i, i % 4096);
+  bitpack::set_xs(std::span{pairs}, 42u);
+  for(unsigned i = 0; i < 100; ++i) REQUIRE(pairs[i] == pair{42, i});
+  bitpack::set_ys(std::span{pairs}, 7u);
+  for(auto const p : pairs) REQUIRE(p == pair{42, 7});
+
+  using ptr = bitpack::tagged_ptr<long*, bool, 1>;
+  std::vector<long> objects(100);
+  std::vector<ptr>  ptrs;
+  for(auto& o : objects) ptrs.emplace_back(&o, false);
+  bitpack::set_tags(std::span{ptrs}, true);
+  for(std::size_t i = 0; i < ptrs.size(); ++i) {
+    REQUIRE(ptrs[i].tag());
+    REQUIRE(ptrs[i].ptr() == &objects[i]);
+  }
+}
+
+TEST_CASE("wide_uint shifts bits across its words") {
+  using bitpack::bits::wide_uint;
+  using wide = wide_uint<3>;
+  wide const one = 1u;
+  REQUIRE((one << 64).words() == wide::words_type{0, 1, 0});
+  REQUIRE((one << 130).words() == wide::words_type{0, 0, 4});
+  REQUIRE((one << 192) == wide{});
+  wide const x{wide::words_type{0xFFFF'0000'0000'0000, 0x1234, 0}};
+  REQUIRE((x << 16).words() == wide::words_type{0, 0x1234'FFFF, 0});
+  REQUIRE((x >> 48).words() == wide::words_type{0x1234'FFFF, 0, 0});
+  REQUIRE((x >> 200) == wide{});
+  REQUIRE(wide{-1} == ~wide{});
+  REQUIRE(bitpack::bits::low_mask<wide>(70).words()
+          == wide::words_type{~std::uint64_t{0}, 0x3F, 0});
+  REQUIRE(bitpack::bits::low_mask<wide>(192) == ~wide{});
+  REQUIRE(static_cast<std::uint16_t>(x >> 60) == 0x234F);
+  REQUIRE((one << 64) > wide{~std::uint64_t{0}});
+  REQUIRE(wide{5u} < wide{6u});
+  REQUIRE(!wide{});
+  REQUIRE(static_cast<bool>(one << 150));
+}
+
+#if BITPACK_HAS_INT128
+TEMPLATE_TEST_CASE("as_UInt and from_UInt work with 128 bit and wider words",
+                   "",
+                   bitpack::bits::uint128_t,
+                   bitpack::bits::wide_uint<2>,
+                   bitpack::bits::wide_uint<3>) {
+  using namespace bitpack::bits;
+  using UInt = TestType;
+  struct sixteen {
+    std::uint64_t a, b;
+    bool          operator==(sixteen const&) const = default;
+  };
+  sixteen const s{0x0102'0304'0506'0708, 0x1112'1314'1516'1718};
+  auto const    native = as_UInt<uint128_t>(s);
+  REQUIRE(static_cast<uint128_t>(as_UInt<UInt>(s)) == native);
+  REQUIRE(from_UInt<sixteen>(as_UInt<UInt>(s)) == s);
+  auto const big = as_UInt<UInt, sixteen, std::endian::big>(s);
+  REQUIRE(static_cast<uint128_t>(big) == byteswap(native));
+  REQUIRE(from_UInt<sixteen, UInt, std::endian::big>(big) == s);
+
+  REQUIRE(from_UInt<double>(as_UInt<UInt>(2.5)) == 2.5);
+  REQUIRE(static_cast<std::uint64_t>(as_UInt<UInt>(-1)) == 0xFFFF'FFFF);
+}
+
+TEST_CASE("UInt_pair packs a 64 bit key and a 40 bit payload in 128 bits") {
+  using entry = bitpack::UInt_pair<std::uint64_t,
+                                   std::uint64_t,
+                                   bitpack::bits::uint128_t,
+                                   40>;
+  STATIC_REQUIRE(sizeof(entry) == 16);
+  STATIC_REQUIRE(entry::is_word_ordered);
+  entry const e{0xFEDC'BA98'7654'3210, 0xAB'CDEF'0123};
+  REQUIRE(e.x() == 0xFEDC'BA98'7654'3210);
+  REQUIRE(e.y() == 0xAB'CDEF'0123);
+  REQUIRE(e.with_y(5).x() == 0xFEDC'BA98'7654'3210);
+  REQUIRE(entry{1, 0xFF'FFFF'FFFF} < entry{2, 0});
+  REQUIRE_THROWS(entry{1, std::uint64_t{1} << 40});
+}
+#endif
+
+TEST_CASE("UInt_pair and packed_struct fields can straddle wide_uint words") {
+  using bitpack::bits::wide_uint;
+  using pair = bitpack::ordered_pair<std::int64_t, double, wide_uint<2>>;
+  pair const p{-3, -0.5};
+  REQUIRE(p.x() == -3);
+  REQUIRE(p.y() == -0.5);
+  REQUIRE(pair{-3, -0.5} < pair{-3, 0.5});
+  REQUIRE(pair{-4, 9.0} < pair{-3, -0.5});
+
+  using bitpack::field;
+  using record = bitpack::packed_struct<wide_uint<3>,
+                                        field<std::uint32_t, 20>,
+                                        field<std::uint64_t>, // bits 76-139
+                                        field<std::uint64_t, 60>,
+                                        field<std::uint16_t>>;
+  record const r{0xABCDE, 0x0123'4567'89AB'CDEF, 0xFFF'FFFF'FFFF'FFFF, 7};
+  auto const [a, b, c, d] = r;
+  REQUIRE(a == 0xABCDE);
+  REQUIRE(b == 0x0123'4567'89AB'CDEF);
+  REQUIRE(c == 0xFFF'FFFF'FFFF'FFFF);
+  REQUIRE(d == 7);
+  REQUIRE(record{1, 0, 0, 0} > record{0, ~std::uint64_t{0}, 1, 1});
+}
+
+// swar
+namespace lanes {
+// check every swar operation against doing it one lane at a time
+template<std::size_t width, class UInt> void check_swar(UInt const a, UInt b) {
+  namespace swar          = bitpack::swar;
+  constexpr auto count    = swar::lane_count<UInt, width>;
+  constexpr auto max      = bitpack::bits::low_mask<UInt>(width);
+  auto const     sum      = swar::add<width>(a, b);
+  auto const     diff     = swar::sub<width>(a, b);
+  auto const     sat_sum  = swar::add_saturate<width>(a, b);
+  auto const     sat_diff = swar::sub_saturate<width>(a, b);
+  auto const     inc      = swar::increment_saturate<width>(a);
+  auto const     some = static_cast<UInt>(swar::high_bits<UInt, width> & b);
+  auto const     inc_some = swar::increment_saturate<width>(a, some);
+  auto const     zeros    = swar::zero_lanes<width>(a);
+  auto const     eq       = swar::equal<width>(a, b);
+  auto const     lt       = swar::less<width>(a, b);
+  std::size_t    first_zero = count, lt_count = 0;
+  for(std::size_t i = 0; i < count; ++i) {
+    auto const x = swar::lane<width>(a, i), y = swar::lane<width>(b, i);
+    REQUIRE(swar::lane<width>(sum, i) == ((x + y) & max));
+    REQUIRE(swar::lane<width>(diff, i) == ((x - y) & max));
+    REQUIRE(swar::lane<width>(sat_sum, i) == (y > max - x ? max : x + y));
+    REQUIRE(swar::lane<width>(sat_diff, i) == (x > y ? x - y : 0));
+    REQUIRE(swar::lane<width>(inc, i) == (x == max ? max : x + 1));
+    REQUIRE(swar::lane<width>(inc_some, i)
+            == (x == max || swar::lane<width>(some, i) == 0 ? x : x + 1));
+    // lane masks: just the top bit
+    auto const top = UInt{1} << (width - 1);
+    REQUIRE(swar::lane<width>(zeros, i) == (x == 0 ? top : 0));
+    REQUIRE(swar::lane<width>(eq, i) == (x == y ? top : 0));
+    REQUIRE(swar::lane<width>(lt, i) == (x < y ? top : 0));
+    REQUIRE(swar::lane<width>(swar::fill_lanes<width>(lt), i)
+            == (x < y ? max : 0));
+    if(x == 0 && first_zero == count) first_zero = i;
+    lt_count += x < y;
+  }
+  REQUIRE(swar::find_first_zero<width>(a) == first_zero);
+  REQUIRE(swar::count_lanes<width>(lt) == lt_count);
+}
+} // namespace lanes
+
+TEST_CASE("swar operations act on each lane separately") {
+  std::mt19937_64 gen{7};
+  // random words, and words of lanes near 0 and the maximum, where carries,
+  // borrows and saturation happen
+  auto const edgy = [&](auto const max) {
+    std::uint64_t w = 0;
+    for(int i = 0; i < 64; ++i) {
+      auto const pick = gen() % 4;
+      w = (w << 1) | (pick == 0 ? 0 : pick == 1 ? 1 : gen() & 1);
+    }
+    return w & max;
+  };
+  for(int i = 0; i < 200; ++i) {
+    auto const a = gen(), b = gen();
+    lanes::check_swar<8>(a, b);
+    lanes::check_swar<8>(a & 0x8181'0000'FFFF'0101, b & 0x0180'00FF'FF00'0101);
+    lanes::check_swar<4>(edgy(~0ull), edgy(~0ull));
+    lanes::check_swar<16>(a, a ^ (b & 0xFFFF'0000'0001'8000));
+    lanes::check_swar<1>(a, b);
+    lanes::check_swar<64>(a, b);
+    lanes::check_swar<4>(static_cast<std::uint16_t>(a),
+                         static_cast<std::uint16_t>(b));
+    lanes::check_swar<2>(static_cast<std::uint8_t>(a),
+                         static_cast<std::uint8_t>(b));
+  }
+}
+
+TEST_CASE("swar saturating counters stop at their maximum") {
+  namespace swar = bitpack::swar;
+  std::uint64_t counters = swar::broadcast<8, std::uint64_t>(253);
+  counters               = swar::with_lane<8>(counters, 3, 0);
+  for(int i = 0; i < 5; ++i) counters = swar::increment_saturate<8>(counters);
+  REQUIRE(counters == 0xFFFF'FFFF'05FF'FFFF);
+  REQUIRE(swar::find_first_zero<8>(counters) == 8);
+  REQUIRE(swar::first_lane<8>(swar::less<8>(counters, 0x1010'1010'1010'1010))
+          == 3);
+  REQUIRE(swar::lane<8>(swar::sub_saturate<8>(counters, 0x0101'0101'0606'0101),
+                        3)
+          == 0);
+  STATIC_REQUIRE(swar::high_bits<std::uint32_t, 8> == 0x8080'8080);
+  STATIC_REQUIRE(swar::increment_saturate<4>(std::uint16_t{0xF0E1})
+                 == 0xF1F2);
+  REQUIRE_THROWS(swar::broadcast<4, std::uint32_t>(16));
+}